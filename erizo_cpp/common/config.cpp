@@ -33,6 +33,15 @@ Config::Config()
     worker_thread_num = 5;
     io_worker_thread_num = 5;
     bridge_io_thread_num = 5;
+    io_worker_busy_poll_us = 0;
+    shared_ice_loop = false;
+    pipeline_latency_stats = false;
+    compositor_thread_num = 2;
+    mixer_thread_num = 4;
+    stats_interval_ms = 0;
+    stats_queue = "erizo_stats";
+    stats_shm_name = "";
+    stats_shm_size = 4 * 1024 * 1024;
 
     stun_server = "stun:stun.l.google.com";
     stun_port = 19302;
@@ -223,6 +232,33 @@ int Config::initConfig(const Json::Value &root)
     worker_thread_num = erizo["worker_thread_num"].asInt();
     io_worker_thread_num = erizo["io_worker_thread_num"].asInt();
     bridge_io_thread_num = erizo["bridge_io_thread_num"].asInt();
+    if (erizo.isMember("io_worker_busy_poll_us") && erizo["io_worker_busy_poll_us"].isInt())
+        io_worker_busy_poll_us = erizo["io_worker_busy_poll_us"].asInt();
+    if (erizo.isMember("shared_ice_loop") && erizo["shared_ice_loop"].isBool())
+        shared_ice_loop = erizo["shared_ice_loop"].asBool();
+    if (erizo.isMember("pipeline_latency_stats") && erizo["pipeline_latency_stats"].isBool())
+        pipeline_latency_stats = erizo["pipeline_latency_stats"].asBool();
+    if (erizo.isMember("compositor_thread_num") && erizo["compositor_thread_num"].isInt())
+        compositor_thread_num = erizo["compositor_thread_num"].asInt();
+    if (erizo.isMember("mixer_thread_num") && erizo["mixer_thread_num"].isInt())
+        mixer_thread_num = erizo["mixer_thread_num"].asInt();
+    if (erizo.isMember("stats_interval_ms") && erizo["stats_interval_ms"].isInt())
+        stats_interval_ms = erizo["stats_interval_ms"].asInt();
+    if (erizo.isMember("stats_queue") && erizo["stats_queue"].isString())
+        stats_queue = erizo["stats_queue"].asString();
+    if (erizo.isMember("stats_shm_name") && erizo["stats_shm_name"].isString())
+        stats_shm_name = erizo["stats_shm_name"].asString();
+    if (erizo.isMember("stats_shm_size") && erizo["stats_shm_size"].isInt())
+        stats_shm_size = erizo["stats_shm_size"].asInt();
+    bridge_io_cpus.clear();
+    if (erizo.isMember("bridge_io_cpus") && erizo["bridge_io_cpus"].isArray())
+    {
+        for (const Json::Value &cpu : erizo["bridge_io_cpus"])
+        {
+            if (cpu.isInt() && cpu.asInt() >= 0)
+                bridge_io_cpus.push_back(cpu.asInt());
+        }
+    }
 
     return 0;
 }
@@ -45,6 +45,25 @@ public:
     int worker_thread_num;
     int io_worker_thread_num;
     int bridge_io_thread_num;
+    // how long an idle io worker spins before sleeping, 0 to sleep at once
+    int io_worker_busy_poll_us;
+    // cpus the bridge receive threads are pinned to, empty to leave them unpinned
+    std::vector<int> bridge_io_cpus;
+    // run libnice agents on io_worker_thread_num shared glib loops instead of one thread each
+    bool shared_ice_loop;
+    // threads shared by all mixers to composite video layers in parallel
+    int compositor_thread_num;
+    // webrtc threads shared by all mixers to run their send and receive calls
+    int mixer_thread_num;
+    // record per handler latency histograms in every media stream's stats
+    bool pipeline_latency_stats;
+    // publish every media stream's stats as one binary batch per interval, 0 to disable
+    int stats_interval_ms;
+    // queue the stats batches are sent to
+    std::string stats_queue;
+    // shared memory object the stats batches are also written to, empty for none
+    std::string stats_shm_name;
+    int stats_shm_size;
 
     // Erizo libnice config
     // stun
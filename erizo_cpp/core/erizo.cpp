@@ -20,6 +20,10 @@
 
 #include <thread/IOThreadPool.h>
 #include <thread/ThreadPool.h>
+#include <thread/GlibContextPool.h>
+#include <thread/CompositorPool.h>
+#include <media/mixers/MixerThreadPool.h>
+#include <stats/StatsExporter.h>
 
 DEFINE_LOGGER(Erizo, "Erizo");
 
@@ -78,11 +82,19 @@ int Erizo::init(const std::string &agent_id, const std::string &erizo_id, const
     erizo_id_ = erizo_id;
 
     io_thread_pool_ = std::make_shared<erizo::IOThreadPool>(Config::getInstance()->io_worker_thread_num);
+    io_thread_pool_->setBusyPoll(std::chrono::microseconds(Config::getInstance()->io_worker_busy_poll_us));
     io_thread_pool_->start();
 
     thread_pool_ = std::make_shared<erizo::ThreadPool>(Config::getInstance()->worker_thread_num);
     thread_pool_->start();
 
+    if (Config::getInstance()->shared_ice_loop)
+        erizo::GlibContextPool::getInstance()->start(Config::getInstance()->io_worker_thread_num);
+    if (Config::getInstance()->compositor_thread_num > 0)
+        erizo::CompositorPool::getInstance()->start(Config::getInstance()->compositor_thread_num);
+    if (Config::getInstance()->mixer_thread_num > 0)
+        erizo::MixerThreadPool::getInstance()->start(Config::getInstance()->mixer_thread_num);
+
     amqp_uniquecast_ = std::make_shared<AMQPHelper>();
     if (amqp_uniquecast_->init(erizo_id_, [this](const std::string &msg) {
             Json::Value root;
@@ -174,6 +186,17 @@ int Erizo::init(const std::string &agent_id, const std::string &erizo_id, const
         ELOG_ERROR("amqp initialize failed");
         return 1;
     }
+
+    if (Config::getInstance()->stats_interval_ms > 0)
+    {
+        std::string stats_queue = Config::getInstance()->stats_queue;
+        erizo::StatsExporter::getInstance()->start(std::chrono::milliseconds(Config::getInstance()->stats_interval_ms),
+                                                   [this, stats_queue](const std::string &batch) {
+                                                       amqp_uniquecast_->sendMessage(stats_queue, stats_queue, batch, "application/octet-stream");
+                                                   },
+                                                   Config::getInstance()->stats_shm_name,
+                                                   Config::getInstance()->stats_shm_size);
+    }
     init_ = true;
     return 0;
 }
@@ -231,6 +254,18 @@ void Erizo::addSubscriber(const Json::Value &root)
             return;
         }
         //混合流
+        if (stream_mixer->getMixerConfig().audio_only)
+        { //纯音频混流直接订阅，参与混音的client收到去掉自己声音的混音
+            std::shared_ptr<Connection> sub_conn = std::make_shared<Connection>();
+            sub_conn->setConnectionListener(this);
+            sub_conn->setAppId(appid);
+            sub_conn->setRoomId(room_id);
+            sub_conn->init(agent_id_, erizo_id_, client_id, subscribe_to, stream_label, false, reply_to, isp, thread_pool_, io_thread_pool_);
+
+            stream_mixer->addSubscriber(client_id, sub_conn->getMediaStream());
+            client->subscribers[subscribe_to] = sub_conn;
+            return;
+        }
         std::shared_ptr<BridgeConn> bridge_conn = getBridgeConn(subscribe_to);
         if (bridge_conn != nullptr)
         {
@@ -273,6 +308,10 @@ void Erizo::removeSubscriber(const Json::Value &root)
     if (bridge_conn != nullptr)
         bridge_conn->removeSubscriber(client_id);
 
+    std::shared_ptr<erizo::StreamMixer> stream_mixer = getStreamMixer(subscribe_to);
+    if (stream_mixer != nullptr)
+        stream_mixer->removeSubscriber(client_id);
+
     std::shared_ptr<Client> client = getOrCreateClient(client_id);
     std::shared_ptr<Connection> sub_conn = getSubscribeConn(client, subscribe_to);
     if (sub_conn != nullptr)
@@ -311,7 +350,11 @@ void Erizo::addMixer(const Json::Value &root)
         if (bridge_conn == nullptr)
         {
             bridge_conn = std::make_shared<BridgeConn>();
-            bridge_conn->init(bridge_stream_id, src_stream_id, ip, port, io_thread_pool_, false, layer.video_ssrc, layer.audio_ssrc);
+            if (bridge_conn->init(bridge_stream_id, src_stream_id, ip, port, io_thread_pool_, false, layer.video_ssrc, layer.audio_ssrc) != 0)
+            {
+                ELOG_ERROR("addMixer bridge conn %s init failed", bridge_stream_id.c_str());
+                continue;
+            }
             bridge_conns_[bridge_stream_id] = bridge_conn;
         }
         bridge_conn->addSubscriber("mixer_" + src_stream_id, stream_mixer);
@@ -394,7 +437,11 @@ void Erizo::addMixerLayer(const Json::Value &root)
     if (bridge_conn == nullptr)
     {
         bridge_conn = std::make_shared<BridgeConn>();
-        bridge_conn->init(bridge_stream_id, src_stream_id, ip, port, io_thread_pool_, false, layer.video_ssrc, layer.audio_ssrc);
+        if (bridge_conn->init(bridge_stream_id, src_stream_id, ip, port, io_thread_pool_, false, layer.video_ssrc, layer.audio_ssrc) != 0)
+        {
+            ELOG_ERROR("addMixerLayer bridge conn %s init failed", bridge_stream_id.c_str());
+            return;
+        }
         bridge_conns_[bridge_stream_id] = bridge_conn;
     }
     bridge_conn->addSubscriber("mixer_" + src_stream_id, stream_mixer);
@@ -587,12 +634,17 @@ void Erizo::addVirtualPublisher(const Json::Value &root)
     uint16_t port = root["senderPort"].asInt();
     uint32_t video_ssrc = root["videoSSRC"].asUInt();
     uint32_t audio_ssrc = root["audioSSRC"].asUInt();
+    uint32_t handle = root.isMember("handle") && root["handle"].isUInt() ? root["handle"].asUInt() : 0;
 
     std::shared_ptr<BridgeConn> bridge_conn = getBridgeConn(bridge_id);
     if (bridge_conn == nullptr)
     {
         bridge_conn = std::make_shared<BridgeConn>();
-        bridge_conn->init(bridge_id, src_stream_id, ip, port, io_thread_pool_, false, video_ssrc, audio_ssrc);
+        if (bridge_conn->init(bridge_id, src_stream_id, ip, port, io_thread_pool_, false, video_ssrc, audio_ssrc, handle) != 0)
+        {
+            ELOG_ERROR("addVirtualPublisher bridge conn %s init failed", bridge_id.c_str());
+            return;
+        }
         bridge_conns_[bridge_id] = bridge_conn;
     }
 }
@@ -627,6 +679,7 @@ void Erizo::addVirtualSubscriber(const Json::Value &root)
     std::string src_stream_id = root["srcStreamId"].asString();
     std::string ip = root["recverIp"].asString();
     uint16_t port = root["recverPort"].asInt();
+    uint32_t handle = root.isMember("handle") && root["handle"].isUInt() ? root["handle"].asUInt() : 0;
 
     std::shared_ptr<BridgeConn> bridge_conn = getBridgeConn(bridge_id);
     if (bridge_conn == nullptr)
@@ -645,7 +698,11 @@ void Erizo::addVirtualSubscriber(const Json::Value &root)
         }
 
         bridge_conn = std::make_shared<BridgeConn>();
-        bridge_conn->init(bridge_id, src_stream_id, ip, port, io_thread_pool_, true);
+        if (bridge_conn->init(bridge_id, src_stream_id, ip, port, io_thread_pool_, true, 0, 0, handle) != 0)
+        {
+            ELOG_ERROR("addVirtualSubscriber bridge conn %s init failed", bridge_id.c_str());
+            return;
+        }
         if (pub_conn)
         {
             pub_conn->addSubscriber(bridge_id, bridge_conn->getBridgeMediaStream());
@@ -896,6 +953,9 @@ void Erizo::close()
     if (!init_)
         return;
 
+    // Stops the batches before the channel they are sent on
+    erizo::StatsExporter::getInstance()->close();
+
     amqp_uniquecast_->close();
     amqp_uniquecast_.reset();
     amqp_uniquecast_ = nullptr;
@@ -911,6 +971,10 @@ void Erizo::close()
     clients_.clear();
     bridge_conns_.clear();
 
+    erizo::GlibContextPool::getInstance()->close();
+    erizo::CompositorPool::getInstance()->close();
+    erizo::MixerThreadPool::getInstance()->close();
+
     agent_id_ = "";
     erizo_id_ = "";
 
@@ -44,7 +44,7 @@ int main(int argc, char *argv[])
 
     dtls::DtlsSocketContext::globalInit();
 
-    if (erizo::BridgeIO::getInstance()->init(argv[3], atoi(argv[4]), Config::getInstance()->bridge_io_thread_num))
+    if (erizo::BridgeIO::getInstance()->init(argv[3], atoi(argv[4]), Config::getInstance()->bridge_io_thread_num, Config::getInstance()->bridge_io_cpus))
     {
         ELOG_ERROR("bridge-io initialize failed");
         return 1;
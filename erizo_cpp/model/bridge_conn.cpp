@@ -6,35 +6,46 @@
 #include <OneToManyProcessor.h>
 #include <thread/IOThreadPool.h>
 
+DEFINE_LOGGER(BridgeConn, "BridgeConn");
+
 BridgeConn::BridgeConn() : bridge_media_stream_(nullptr),
                            otm_processor_(nullptr),
                            bridge_stream_id_(""),
                            src_stream_id_(""),
+                           handle_(0),
                            init_(false)
 {
 }
 
 BridgeConn::~BridgeConn() {}
 
-void BridgeConn::init(const std::string &bridge_stream_id,
-                      const std::string &src_stream_id,
-                      const std::string &ip,
-                      uint16_t port,
-                      std::shared_ptr<erizo::IOThreadPool> io_thread_pool,
-                      bool is_send,
-                      uint32_t video_ssrc,
-                      uint32_t audio_ssrc)
+int BridgeConn::init(const std::string &bridge_stream_id,
+                     const std::string &src_stream_id,
+                     const std::string &ip,
+                     uint16_t port,
+                     std::shared_ptr<erizo::IOThreadPool> io_thread_pool,
+                     bool is_send,
+                     uint32_t video_ssrc,
+                     uint32_t audio_ssrc,
+                     uint32_t handle)
 {
     if (init_)
-        return;
+        return 0;
 
     bridge_stream_id_ = bridge_stream_id;
     src_stream_id_ = src_stream_id;
+    // both nodes derive the same handle from the bridge id unless signaling assigned one
+    handle_ = handle != 0 ? handle : erizo::BridgeIO::getStreamHandle(bridge_stream_id_);
     is_send_ = is_send;
 
     bridge_media_stream_ = std::make_shared<erizo::BridgeMediaStream>();
     std::shared_ptr<erizo::IOWorker> io_worker = io_thread_pool->getLessUsedIOWorker();
-    bridge_media_stream_->init(ip, port, bridge_stream_id_, io_worker, !is_send_, video_ssrc, audio_ssrc);
+    if (bridge_media_stream_->init(ip, port, bridge_stream_id_, handle_, io_worker, !is_send_, video_ssrc, audio_ssrc) != 0)
+    {
+        ELOG_ERROR("bridge stream %s init failed", bridge_stream_id_.c_str());
+        bridge_media_stream_.reset();
+        return 1;
+    }
 
     if (!is_send_)
     {
@@ -45,8 +56,23 @@ void BridgeConn::init(const std::string &bridge_stream_id,
         otm_processor_->setPublisher(bridge_media_stream_);
     }
 
-    erizo::BridgeIO::getInstance()->addStream(bridge_stream_id_, bridge_media_stream_);
+    if (!erizo::BridgeIO::getInstance()->addStream(handle_, bridge_media_stream_))
+    {
+        ELOG_ERROR("bridge stream %s can't register handle %u", bridge_stream_id_.c_str(), handle_);
+        if (otm_processor_)
+        {
+            otm_processor_->close();
+            otm_processor_.reset();
+        }
+        bridge_media_stream_->setAudioSink(nullptr);
+        bridge_media_stream_->setVideoSink(nullptr);
+        bridge_media_stream_->setEventSink(nullptr);
+        bridge_media_stream_->uninit();
+        bridge_media_stream_.reset();
+        return 1;
+    }
     init_ = true;
+    return 0;
 }
 
 // void BridgeConn::init(const std::string &bridge_stream_id,
@@ -78,7 +104,7 @@ void BridgeConn::close()
 {
     if (!init_)
         return;
-    erizo::BridgeIO::getInstance()->removeStream(bridge_stream_id_);
+    erizo::BridgeIO::getInstance()->removeStream(handle_, bridge_media_stream_);
 
     bridge_media_stream_->setFeedbackSink(nullptr);
     bridge_media_stream_->setAudioSink(nullptr);
@@ -15,18 +15,22 @@ class MediaStream;
 
 class BridgeConn
 {
+    DECLARE_LOGGER();
+
 public:
     BridgeConn();
     ~BridgeConn();
 
-    void init(const std::string &bridge_stream_id,
-              const std::string &src_stream_id,
-              const std::string &ip,
-              uint16_t port,
-              std::shared_ptr<erizo::IOThreadPool> io_thread_pool,
-              bool is_send,
-              uint32_t video_ssrc = 0,
-              uint32_t audio_ssrc = 0);
+    // Returns 1 when the endpoint can't be resolved or the handle is taken by another stream
+    int init(const std::string &bridge_stream_id,
+             const std::string &src_stream_id,
+             const std::string &ip,
+             uint16_t port,
+             std::shared_ptr<erizo::IOThreadPool> io_thread_pool,
+             bool is_send,
+             uint32_t video_ssrc = 0,
+             uint32_t audio_ssrc = 0,
+             uint32_t handle = 0);
 
     // void init(const std::string &bridge_stream_id,
     //           const std::string &src_stream_id,
@@ -58,6 +62,7 @@ private:
     
     std::string bridge_stream_id_;
     std::string src_stream_id_;
+    uint32_t handle_;
     bool is_send_;
     bool init_;
 
@@ -8,6 +8,7 @@
 #include <thread/ThreadPool.h>
 #include <thread/IOThreadPool.h>
 #include <MediaStream.h>
+#include <stats/StatsExporter.h>
 
 #include "rabbitmq/amqp_helper.h"
 #include "common/utils.h"
@@ -78,6 +79,7 @@ void Connection::init(const std::string &agent_id,
 
     std::shared_ptr<erizo::Worker> ms_worker = thread_pool->getLessUsedWorker();
     media_stream_ = std::make_shared<erizo::MediaStream>(ms_worker, webrtc_connection_, stream_id, label_, is_publisher_);
+    media_stream_->setLatencyStats(Config::getInstance()->pipeline_latency_stats);
 
     if (is_publisher_)
     {
@@ -90,6 +92,7 @@ void Connection::init(const std::string &agent_id,
 
     webrtc_connection_->addMediaStream(media_stream_);
     webrtc_connection_->init();
+    erizo::StatsExporter::getInstance()->addStream(client_id_ + "/" + stream_id_, media_stream_);
     init_ = true;
 }
 
@@ -98,6 +101,7 @@ void Connection::close()
     if (!init_)
         return;
 
+    erizo::StatsExporter::getInstance()->removeStream(client_id_ + "/" + stream_id_);
     webrtc_connection_->setWebRtcConnectionEventListener(nullptr);
     webrtc_connection_->close();
     webrtc_connection_.reset();
@@ -164,7 +164,7 @@ int AMQPHelper::init(const std::string &binding_key, const std::function<void(co
             {
                 AMQPData data = send_queue_.front();
                 send_queue_.pop();
-                send(data.exchange, data.queuename, data.binding_key, data.msg);
+                send(data.exchange, data.queuename, data.binding_key, data.msg, data.content_type);
             }
             send_cond_.wait(lock);
         }
@@ -200,21 +200,25 @@ void AMQPHelper::close()
     init_ = false;
 }
 
-void AMQPHelper::sendMessage(const std::string &queuename, const std::string &binding_key, const std::string &send_msg)
+void AMQPHelper::sendMessage(const std::string &queuename,
+                             const std::string &binding_key,
+                             const std::string &send_msg,
+                             const std::string &content_type)
 {
     std::unique_lock<std::mutex> lock(send_queue_mux_);
-    send_queue_.push({Config::getInstance()->uniquecast_exchange, queuename, binding_key, send_msg});
+    send_queue_.push({Config::getInstance()->uniquecast_exchange, queuename, binding_key, send_msg, content_type});
     send_cond_.notify_one();
 }
 
 int AMQPHelper::send(const std::string &exchange,
                      const std::string &queuename,
                      const std::string &binding_key,
-                     const std::string &send_msg)
+                     const std::string &send_msg,
+                     const std::string &content_type)
 {
     amqp_basic_properties_t props;
     props._flags = AMQP_BASIC_CONTENT_TYPE_FLAG;
-    props.content_type = amqp_cstring_bytes("application/json");
+    props.content_type = amqp_cstring_bytes(content_type.c_str());
     props.delivery_mode = 2;
     props.correlation_id = amqp_cstring_bytes("1");
     props.reply_to = amqp_bytes_malloc_dup(amqp_cstring_bytes(queuename.c_str()));
@@ -224,9 +228,13 @@ int AMQPHelper::send(const std::string &exchange,
         return 1;
     }
 
+    // The body may be binary, so it is not taken as a C string
+    amqp_bytes_t body;
+    body.len = send_msg.size();
+    body.bytes = const_cast<char *>(send_msg.data());
     amqp_basic_publish(conn_, 1, amqp_cstring_bytes(exchange.c_str()),
                        amqp_cstring_bytes(binding_key.c_str()), 0, 0,
-                       &props, amqp_cstring_bytes(send_msg.c_str()));
+                       &props, body);
     amqp_bytes_free(props.reply_to);
     return 0;
 }
\ No newline at end of file
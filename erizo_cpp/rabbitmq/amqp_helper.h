@@ -24,6 +24,7 @@ class AMQPHelper
     std::string queuename;
     std::string binding_key;
     std::string msg;
+    std::string content_type;
   };
 
 public:
@@ -35,14 +36,16 @@ public:
 
   void sendMessage(const std::string &queuename,
                    const std::string &binding_key,
-                   const std::string &send_msg);
+                   const std::string &send_msg,
+                   const std::string &content_type = "application/json");
 
 private:
   int checkError(amqp_rpc_reply_t x);
   int send(const std::string &exchange,
            const std::string &queuename,
            const std::string &binding_key,
-           const std::string &send_msg);
+           const std::string &send_msg,
+           const std::string &content_type);
 
 private:
   std::mutex send_queue_mux_;
@@ -4,9 +4,16 @@
 #include <arpa/inet.h>
 #include <error.h>
 #include <fcntl.h>
+#include <linux/filter.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
 
 #include <event2/event.h>
 
+#include <cstddef>
+#include <cstdint>
+
 #define UR_CLIENT_SOCK_BUF_SIZE (65536)
 #define UR_SERVER_SOCK_BUF_SIZE (UR_CLIENT_SOCK_BUF_SIZE * 32)
 
@@ -77,6 +84,55 @@ static int socket_set_nonblocking(int fd)
     return 0;
 }
 
+// Steers each datagram of a SO_REUSEPORT group to socket (handle % group_size), so one stream
+// is always read by the same thread no matter how the kernel would hash the peer 4-tuple.
+// Datagrams too short to carry a BridgeHeader end up on socket 0.
+static int socket_attach_reuseport_cbpf(int fd, int group_size)
+{
+    sock_filter code[] = {
+        // A = handle, the filter runs with the UDP payload at offset 0
+        {BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(offsetof(BridgeHeader, handle))},
+        // A = A % group_size
+        {BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<uint32_t>(group_size)},
+        // return A
+        {BPF_RET | BPF_A, 0, 0, 0},
+    };
+    sock_fprog prog;
+    prog.len = sizeof(code) / sizeof(code[0]);
+    prog.filter = code;
+    if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, (const void *)&prog, (socklen_t)sizeof(prog)) < 0)
+    {
+        perror("SO_ATTACH_REUSEPORT_CBPF");
+        return -1;
+    }
+    return 0;
+}
+
+static int socket_set_incoming_cpu(int fd, int cpu)
+{
+    if (setsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, (const void *)&cpu, (socklen_t)sizeof(cpu)) < 0)
+    {
+        perror("SO_INCOMING_CPU");
+        return -1;
+    }
+    return 0;
+}
+
+static int thread_set_cpu(int cpu)
+{
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+    if (ret != 0)
+    {
+        errno = ret;
+        perror("pthread_setaffinity_np");
+        return -1;
+    }
+    return 0;
+}
+
 DEFINE_LOGGER(BridgeIO, "BridgeIO");
 
 BridgeIO *BridgeIO::m_instance = nullptr;
@@ -88,71 +144,150 @@ BridgeIO *BridgeIO::getInstance()
     return m_instance;
 }
 
-void BridgeIO::addStream(const std::string &stream_id, std::shared_ptr<BridgeMediaStream> stream)
+uint32_t BridgeIO::getStreamHandle(const std::string &stream_id)
 {
-    std::unique_lock<std::mutex>(m_streams_lock);
-    m_streams[stream_id] = stream;
+    // FNV-1a, never 0 since 0 marks an empty slot
+    uint32_t hash = 2166136261u;
+    for (char c : stream_id)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash == 0 ? 1 : hash;
 }
 
-void BridgeIO::removeStream(const std::string &stream_id)
+void BridgeIO::onQuiescent(int reader)
 {
-    std::unique_lock<std::mutex>(m_streams_lock);
-    m_streams.erase(stream_id);
+    m_streams.onQuiescent(reader);
 }
 
-std::shared_ptr<BridgeMediaStream> BridgeIO::getStream(std::string &stream_id)
+bool BridgeIO::addStream(uint32_t handle, std::shared_ptr<BridgeMediaStream> stream)
 {
-    std::unique_lock<std::mutex>(m_streams_lock);
-    auto it = m_streams.find(stream_id);
-    if (it != m_streams.end())
-        return it->second;
-    return nullptr;
+    if (!m_streams.add(handle, stream))
+    {
+        ELOG_ERROR("bridge stream handle %u already in use", handle);
+        return false;
+    }
+    return true;
 }
 
-void BridgeIO::onSend(const std::string &ip, uint16_t port, const std::string stream_id, std::shared_ptr<DataPacket> data_packet)
+void BridgeIO::removeStream(uint32_t handle, const std::shared_ptr<BridgeMediaStream> &stream)
 {
-    std::shared_ptr<IOWorker> worker = m_io_thread_pool->getLessUsedIOWorker();
+    m_streams.remove(handle, stream);
+}
 
-    worker->task([stream_id, data_packet, ip, port, this] {
-        int ret;
-        sockaddr_in sa;
-        char *data;
-        int length;
+std::shared_ptr<BridgeMediaStream> BridgeIO::getStream(uint32_t handle)
+{
+    return m_streams.get(handle);
+}
 
-        memset(&sa, 0, sizeof(sockaddr_in));
-        if (inet_pton(AF_INET, ip.c_str(), &sa.sin_addr) != 1)
-        {
-            ELOG_ERROR("message: convert address string to address structure failed");
-            return;
-        }
+bool BridgeIO::resolveEndpoint(const std::string &ip, uint16_t port, uint32_t handle, BridgeEndpoint *endpoint)
+{
+    if (m_thread_num <= 0)
+    {
+        ELOG_ERROR("message: BridgeIO is not initialized");
+        return false;
+    }
+    memset(&endpoint->addr, 0, sizeof(sockaddr_in));
+    if (inet_pton(AF_INET, ip.c_str(), &endpoint->addr.sin_addr) != 1)
+    {
+        ELOG_ERROR("message: convert address string to address structure failed");
+        return false;
+    }
+    endpoint->addr.sin_family = AF_INET;
+    endpoint->addr.sin_port = htons(port);
+    endpoint->socket_index = handle % m_thread_num;
+    return true;
+}
 
-        sa.sin_family = AF_INET;
-        sa.sin_port = htons(port);
+void BridgeIO::onSend(const BridgeEndpoint &endpoint, std::shared_ptr<DataPacket> data_packet)
+{
+    int index = endpoint.socket_index;
+    if (index < 0 || !m_run)
+        return;
 
-        size_t hash_val = std::hash<std::string>{}(stream_id);
-        int index = hash_val % m_thread_num;
+    SendQueue *queue = m_send_queues[index].get();
+    if (!queue->ring.push({endpoint.addr, std::move(data_packet)}))
+    {
+        ELOG_DEBUG("message: bridge send ring full, dropping packet");
+        return;
+    }
+    // Only the push that finds no flush pending wakes the worker
+    if (!queue->flush_scheduled.exchange(true))
+    {
+        m_send_workers[index]->task([this, index] {
+            flush(index);
+        });
+    }
+}
 
-        std::unique_lock<std::mutex>(*(m_sockfds_lock[index].get()));
+void BridgeIO::flush(int index)
+{
+    SendQueue *queue = m_send_queues[index].get();
+    // Cleared before draining: a packet pushed after the drain below schedules a new flush
+    queue->flush_scheduled = false;
+
+    OutgoingPacket packets[BRIDGE_IO_BATCH_SIZE];
+    mmsghdr msgs[BRIDGE_IO_BATCH_SIZE];
+    iovec iovecs[BRIDGE_IO_BATCH_SIZE];
+    for (;;)
+    {
+        unsigned int count = 0;
+        while (count < BRIDGE_IO_BATCH_SIZE && queue->ring.pop(&packets[count]))
+        {
+            iovecs[count].iov_base = packets[count].packet->data;
+            iovecs[count].iov_len = packets[count].packet->length;
+            memset(&msgs[count], 0, sizeof(mmsghdr));
+            msgs[count].msg_hdr.msg_name = &packets[count].addr;
+            msgs[count].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            msgs[count].msg_hdr.msg_iov = &iovecs[count];
+            msgs[count].msg_hdr.msg_iovlen = 1;
+            count++;
+        }
+        if (count == 0)
+            break;
 
-        data = data_packet->data;
-        length = data_packet->length;
-        do
+        unsigned int sent = 0;
+        while (sent < count)
         {
-            ret = ::sendto(m_sockfds[index], data, length, 0, (sockaddr *)&sa, sizeof(sockaddr_in));
-        } while (ret < 0 && errno == EINTR);
-    });
+            int ret;
+            do
+            {
+                ret = ::sendmmsg(m_sockfds[index], msgs + sent, count - sent, 0);
+            } while (ret < 0 && errno == EINTR);
+
+            if (ret <= 0)
+            {
+                // Socket buffer full or a hard error on the first datagram: drop it and move on,
+                // like a failed sendto did
+                ELOG_DEBUG("message: sendmmsg failed, %s", strerror(errno));
+                ret = 1;
+            }
+            sent += ret;
+        }
+        for (unsigned int i = 0; i < count; i++)
+            packets[i].packet.reset();
+    }
 }
 
-void BridgeIO::onRecv(char *data, int length)
+void BridgeIO::onRecv(std::shared_ptr<DataPacket> data_packet)
 {
-    std::string stream_id(data, STREAM_ID_LEN);
-    std::shared_ptr<BridgeMediaStream> stream = getStream(stream_id);
+    if (data_packet->length < BRIDGE_HEADER_LEN)
+        return;
+    const BridgeHeader *header = reinterpret_cast<const BridgeHeader *>(data_packet->data);
+    if (header->version != BRIDGE_HEADER_VERSION)
+    {
+        ELOG_WARN("bridge recv unsupported header version:%u", header->version);
+        return;
+    }
+    uint32_t handle = header->getHandle();
+    BridgeMediaStream *stream = m_streams.find(handle);
     if (stream == nullptr) {
-        ELOG_ERROR("**************** bridge recv unknown stream_id:%s ****************", stream_id);
+        ELOG_ERROR("**************** bridge recv unknown stream handle:%u ****************", header->getHandle());
         return;
     }
-        
-    stream->onRead(std::make_shared<DataPacket>(1, data, length, OTHER_PACKET));
+
+    stream->onRead(std::move(data_packet));
 }
 
 int BridgeIO::create_udp_socket(const char *local_saddr, int local_port)
@@ -196,62 +331,112 @@ int BridgeIO::create_udp_socket(const char *local_saddr, int local_port)
     return udp_fd;
 }
 
+// Per receive thread: datagrams are read straight into pooled packets, a batch per wakeup
+struct RecvBatch
+{
+    int reader;
+    mmsghdr msgs[BRIDGE_IO_BATCH_SIZE];
+    iovec iovecs[BRIDGE_IO_BATCH_SIZE];
+    std::shared_ptr<DataPacket> packets[BRIDGE_IO_BATCH_SIZE];
+
+    void arm(int index)
+    {
+        if (packets[index] == nullptr)
+        {
+            packets[index] = makeDataPacket();
+            packets[index]->comp = 1;
+            packets[index]->type = OTHER_PACKET;
+        }
+        iovecs[index].iov_base = packets[index]->data;
+        iovecs[index].iov_len = MTU_SIZE;
+        memset(&msgs[index], 0, sizeof(mmsghdr));
+        msgs[index].msg_hdr.msg_iov = &iovecs[index];
+        msgs[index].msg_hdr.msg_iovlen = 1;
+    }
+};
+
 static void input_handler(int fd, short what, void *arg)
 {
     if (!(what & EV_READ))
         return;
 
+    RecvBatch *batch = reinterpret_cast<RecvBatch *>(arg);
     int ret;
-    char buf[MTU_SIZE];
-
     do
     {
-        ret = recv(fd, buf, MTU_SIZE, 0);
-    } while (ret < 0 && errno == EINTR);
+        for (int i = 0; i < BRIDGE_IO_BATCH_SIZE; i++)
+            batch->arm(i);
 
-    if (ret > 0 && ret < MTU_SIZE)
-    {
-        BridgeIO::getInstance()->onRecv(buf, ret);
-    }
+        do
+        {
+            ret = recvmmsg(fd, batch->msgs, BRIDGE_IO_BATCH_SIZE, MSG_DONTWAIT, NULL);
+        } while (ret < 0 && errno == EINTR);
+
+        for (int i = 0; i < ret; i++)
+        {
+            int length = batch->msgs[i].msg_len;
+            if (length <= 0 || (batch->msgs[i].msg_hdr.msg_flags & MSG_TRUNC))
+                continue;
+            std::shared_ptr<DataPacket> packet = std::move(batch->packets[i]);
+            packet->length = length;
+            BridgeIO::getInstance()->onRecv(std::move(packet));
+        }
+        BridgeIO::getInstance()->onQuiescent(batch->reader);
+        // A full batch means more may be queued on the socket
+    } while (ret == BRIDGE_IO_BATCH_SIZE);
 }
 
 BridgeIO::BridgeIO()
 {
     m_thread_num = 0;
-    m_io_thread_pool = nullptr;
     m_run = false;
     m_init = false;
 }
 
-int BridgeIO::init(const std::string &ip, uint16_t port, int thread_num)
+int BridgeIO::init(const std::string &ip, uint16_t port, int thread_num, const std::vector<int> &cpus)
 {
     if (m_init)
         return 0;
 
+    m_streams.setReaders(thread_num);
     m_thread_num = thread_num;
 
-    m_io_thread_pool = std::make_shared<erizo::IOThreadPool>(thread_num);
-    m_io_thread_pool->start();
-
     m_threads.resize(thread_num);
     m_sockfds.resize(thread_num);
-    m_sockfds_lock.resize(thread_num);
+    m_send_queues.resize(thread_num);
+    m_send_workers.resize(thread_num);
 
-    m_run = true;
+    // Sockets join the reuseport group in bind order, so socket i is group index i
     for (int i = 0; i < thread_num; i++)
     {
         m_sockfds[i] = create_udp_socket(ip.c_str(), port);
-        if (!m_sockfds[i])
+        if (m_sockfds[i] < 0)
         {
             ELOG_ERROR("create socket failed,%s", strerror(errno));
             return 1;
         }
-        m_sockfds_lock[i] = std::unique_ptr<std::mutex>(new std::mutex());
-        m_threads[i] = std::unique_ptr<std::thread>(new std::thread([this, i] {
+        if (!cpus.empty())
+            socket_set_incoming_cpu(m_sockfds[i], cpus[i % cpus.size()]);
+    }
+    if (thread_num > 1 && socket_attach_reuseport_cbpf(m_sockfds[0], thread_num) < 0)
+        ELOG_WARN("attach reuseport steering failed, falling back to kernel hashing");
+
+    m_run = true;
+    for (int i = 0; i < thread_num; i++)
+    {
+        int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+        m_send_queues[i] = std::unique_ptr<SendQueue>(new SendQueue());
+        m_send_workers[i] = std::make_shared<IOWorker>();
+        m_send_workers[i]->start();
+        m_threads[i] = std::unique_ptr<std::thread>(new std::thread([this, i, cpu] {
+            if (cpu >= 0)
+                thread_set_cpu(cpu);
+            RecvBatch batch;
+            batch.reader = i;
             event_config *cfg = event_config_new();
             event_config_set_flag(cfg, EVENT_BASE_FLAG_EPOLL_USE_CHANGELIST);
             event_base *base = event_base_new_with_config(cfg);
-            event *udp_ev = event_new(base, m_sockfds[i], EV_READ | EV_PERSIST, input_handler, NULL);
+            event *udp_ev = event_new(base, m_sockfds[i], EV_READ | EV_PERSIST, input_handler, &batch);
             event_add(udp_ev, NULL);
             while (m_run)
             {
@@ -260,10 +445,19 @@ int BridgeIO::init(const std::string &ip, uint16_t port, int thread_num)
                 timeout.tv_usec = 100000;
                 event_base_loopexit(base, &timeout);
                 event_base_dispatch(base);
+                onQuiescent(i);
+                // publish() retires tables before any reader can be past them, so without this
+                // the streams the last removals left in them would wait for the next add/remove
+                if (i == 0)
+                    m_streams.reclaim();
             }
+            // This reader is gone, it must not hold back reclamation
+            m_streams.offline(i);
+            event_free(udp_ev);
             event_base_free(base);
         }));
     }
+    m_init = true;
     return 0;
 }
 
@@ -272,18 +466,24 @@ void BridgeIO::close()
     if (!m_init)
         return;
 
+    // Receive threads go first: a packet they are still delivering can be forwarded to another
+    // bridge and reach onSend, which needs the send workers
     m_run = false;
     for (int i = 0; i < m_thread_num; i++)
     {
         m_threads[i]->join();
         m_threads[i].reset();
         m_threads[i] = nullptr;
-        ::close(m_sockfds[i]);
     }
 
-    m_io_thread_pool->close();
-    m_io_thread_pool.reset();
-    m_io_thread_pool = nullptr;
+    // Closed but kept, a media worker racing with close may still post to them after m_run
+    // is cleared; they are replaced on the next init
+    for (int i = 0; i < m_thread_num; i++)
+    {
+        m_send_workers[i]->close();
+        ::close(m_sockfds[i]);
+    }
+    m_streams.reclaim();
 
     m_init = false;
 }
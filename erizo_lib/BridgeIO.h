@@ -1,18 +1,62 @@
 #ifndef ERIZO_BRIDGE_IO_H
 #define ERIZO_BRIDGE_IO_H
 
-#include "thread/IOThreadPool.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lib/MpscRing.h"
+#include "lib/ShardedRegistry.h"
+#include "thread/IOWorker.h"
 #include "MediaDefinitions.h"
 #include "./logger.h"
 
 #define MTU_SIZE 1500
-#define STREAM_ID_LEN 18
+// max datagrams moved per recvmmsg/sendmmsg call
+#define BRIDGE_IO_BATCH_SIZE 32
+// packets a send socket can hold before new ones are dropped
+#define BRIDGE_SEND_RING_SIZE 4096
+
+// stream registry shards, a power of two
+#define BRIDGE_STREAM_SHARDS 16
+
+#define BRIDGE_HEADER_VERSION 1
+#define BRIDGE_FLAG_RTCP 0x01
 
 namespace erizo
 {
 
 class BridgeMediaStream;
 
+// Prepended to every packet exchanged between erizo nodes
+struct BridgeHeader
+{
+  uint8_t version;
+  uint8_t media_type; // packetType of the payload
+  uint8_t flags;
+  uint8_t reserved;
+  uint32_t handle; // network byte order
+
+  uint32_t getHandle() const { return ntohl(handle); }
+  void setHandle(uint32_t stream_handle) { handle = htonl(stream_handle); }
+};
+
+#define BRIDGE_HEADER_LEN (static_cast<int>(sizeof(BridgeHeader)))
+
+// Where a bridge stream sends to, resolved once when the stream is set up
+struct BridgeEndpoint
+{
+  sockaddr_in addr;
+  int socket_index = -1;
+};
+
 class BridgeIO
 {
   DECLARE_LOGGER();
@@ -21,29 +65,56 @@ public:
   static BridgeIO *getInstance();
   ~BridgeIO();
 
-  void addStream(const std::string &stream_id, std::shared_ptr<BridgeMediaStream> stream);
-  void removeStream(const std::string &stream_id);
-  std::shared_ptr<BridgeMediaStream> getStream(std::string &stream_id);
+  // Handle both nodes agree on for a bridge stream id, when signaling does not provide one
+  static uint32_t getStreamHandle(const std::string &stream_id);
 
-  void onSend(const std::string &ip,uint16_t port,const std::string stream_id,std::shared_ptr<DataPacket> data_packet);
-  void onRecv(char *data, int length);
+  bool addStream(uint32_t handle, std::shared_ptr<BridgeMediaStream> stream);
+  // Only removes the handle while it still belongs to stream, so a stream that lost a handle
+  // collision can't unregister the one that owns it
+  void removeStream(uint32_t handle, const std::shared_ptr<BridgeMediaStream> &stream);
+  std::shared_ptr<BridgeMediaStream> getStream(uint32_t handle);
 
-  int init(const std::string &ip, uint16_t port, int thread_num);
+  // Resolves ip:port and pins the stream to one send socket, so its packets stay in order
+  bool resolveEndpoint(const std::string &ip, uint16_t port, uint32_t handle, BridgeEndpoint *endpoint);
+  void onSend(const BridgeEndpoint &endpoint, std::shared_ptr<DataPacket> data_packet);
+  // Receive thread only: looks the stream up without taking any lock
+  void onRecv(std::shared_ptr<DataPacket> data_packet);
+  // Called by receive thread `reader` whenever it holds no stream table pointer
+  void onQuiescent(int reader);
+
+  // Receive thread i is pinned to cpus[i % cpus.size()] unless cpus is empty
+  int init(const std::string &ip, uint16_t port, int thread_num, const std::vector<int> &cpus = std::vector<int>());
   void close();
 
 private:
+  struct OutgoingPacket
+  {
+    sockaddr_in addr;
+    std::shared_ptr<DataPacket> packet;
+  };
+
+  // Packets waiting for one socket: any thread pushes, only the socket's worker drains it
+  // with sendmmsg
+  struct SendQueue
+  {
+    SendQueue() : ring(BRIDGE_SEND_RING_SIZE), flush_scheduled{false} {}
+    MpscRing<OutgoingPacket> ring;
+    std::atomic<bool> flush_scheduled;
+  };
+
   BridgeIO();
   int create_udp_socket(const char *local_saddr, int local_port);
+  void flush(int index);
 
 private:
   std::vector<std::unique_ptr<std::thread>> m_threads;
-  std::vector<std::unique_ptr<std::mutex>> m_sockfds_lock;
+  std::vector<std::unique_ptr<SendQueue>> m_send_queues;
+  std::vector<std::shared_ptr<IOWorker>> m_send_workers;
   std::vector<int> m_sockfds;
-  std::map<std::string, std::shared_ptr<BridgeMediaStream>> m_streams;
-  std::mutex m_streams_lock;
+  // Receive thread i is reader i
+  ShardedRegistry<BridgeMediaStream, BRIDGE_STREAM_SHARDS> m_streams;
 
   int m_thread_num;
-  std::shared_ptr<IOThreadPool> m_io_thread_pool;
   std::atomic<bool> m_run;
   bool m_init;
   
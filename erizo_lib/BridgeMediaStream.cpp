@@ -13,6 +13,7 @@ BridgeMediaStream::BridgeMediaStream()
     ip_ = "";
     port_ = 0;
     stream_id_ = "";
+    handle_ = 0;
     io_worker_ = nullptr;
     packet_buf_ = nullptr;
     pipeline_ = nullptr;
@@ -36,6 +37,7 @@ void BridgeMediaStream::initializePipeline()
 int BridgeMediaStream::init(const std::string &ip,
                             uint16_t port,
                             const std::string &stream_id,
+                            uint32_t handle,
                             std::shared_ptr<erizo::IOWorker> io_worker,
                             bool is_publisher,
                             uint32_t video_ssrc,
@@ -44,9 +46,16 @@ int BridgeMediaStream::init(const std::string &ip,
     if (init_)
         return 0;
 
+    if (!BridgeIO::getInstance()->resolveEndpoint(ip, port, handle, &endpoint_))
+    {
+        ELOG_ERROR("message: resolve bridge endpoint failed, ip:%s port:%d", ip.c_str(), port);
+        return 1;
+    }
+
     ip_ = ip;
     port_ = port;
     stream_id_ = stream_id;
+    handle_ = handle;
     io_worker_ = io_worker;
     io_worker_->start();
     is_publisher_ = is_publisher;
@@ -61,10 +70,6 @@ int BridgeMediaStream::init(const std::string &ip,
 
     initializePipeline();
 
-    memset(send_buf_, 0, sizeof(send_buf_));
-    memset(recv_buf_, 0, sizeof(recv_buf_));
-    memcpy(send_buf_, stream_id_.c_str(), STREAM_ID_LEN);
-
     init_ = true;
     return 0;
 }
@@ -93,14 +98,25 @@ std::shared_ptr<DataPacket> BridgeMediaStream::addBridgeHeader(std::shared_ptr<D
     char *data = data_packet->data;
     int length = data_packet->length;
 
-    if (length + STREAM_ID_LEN > MTU_SIZE)
+    if (length + BRIDGE_HEADER_LEN > MTU_SIZE)
     {
         ELOG_WARN("buffer full");
         return nullptr;
     }
 
-    memcpy(send_buf_ + STREAM_ID_LEN, data, length);
-    return std::make_shared<DataPacket>(1, send_buf_, length + STREAM_ID_LEN, OTHER_PACKET);
+    std::shared_ptr<DataPacket> bridge_packet = makeDataPacket();
+    bridge_packet->comp = 1;
+    bridge_packet->type = OTHER_PACKET;
+    bridge_packet->received_time_ms = data_packet->received_time_ms;
+    BridgeHeader *header = reinterpret_cast<BridgeHeader *>(bridge_packet->data);
+    header->version = BRIDGE_HEADER_VERSION;
+    header->media_type = static_cast<uint8_t>(data_packet->type);
+    header->flags = reinterpret_cast<RtcpHeader *>(data)->isRtcp() ? BRIDGE_FLAG_RTCP : 0;
+    header->reserved = 0;
+    header->setHandle(handle_);
+    memcpy(bridge_packet->data + BRIDGE_HEADER_LEN, data, length);
+    bridge_packet->length = length + BRIDGE_HEADER_LEN;
+    return bridge_packet;
 }
 
 std::shared_ptr<DataPacket> BridgeMediaStream::removeBridgeHeader(std::shared_ptr<DataPacket> data_packet)
@@ -108,14 +124,20 @@ std::shared_ptr<DataPacket> BridgeMediaStream::removeBridgeHeader(std::shared_pt
     char *data = data_packet->data;
     int length = data_packet->length;
 
-    if (length - STREAM_ID_LEN > MTU_SIZE)
+    if (length <= BRIDGE_HEADER_LEN)
     {
-        ELOG_WARN("buffer full");
+        ELOG_WARN("bridge packet too short");
         return nullptr;
     }
 
-    memcpy(recv_buf_, data + STREAM_ID_LEN, length - STREAM_ID_LEN);
-    return std::make_shared<DataPacket>(1, recv_buf_, length - STREAM_ID_LEN, OTHER_PACKET);
+    const BridgeHeader *header = reinterpret_cast<const BridgeHeader *>(data);
+    if (header->media_type <= OTHER_PACKET)
+        data_packet->type = static_cast<packetType>(header->media_type);
+
+    // The bridge packet is owned by this read path only, strip the header in place
+    memmove(data, data + BRIDGE_HEADER_LEN, length - BRIDGE_HEADER_LEN);
+    data_packet->length = length - BRIDGE_HEADER_LEN;
+    return data_packet;
 }
 
 int BridgeMediaStream::deliverAudioData_(std::shared_ptr<DataPacket> data_packet, const std::string &stream_id)
@@ -255,7 +277,7 @@ void BridgeMediaStream::write(std::shared_ptr<DataPacket> data_packet)
     std::shared_ptr<DataPacket> bridge_packet = addBridgeHeader(std::move(data_packet));
     if (bridge_packet != nullptr) {
         // ELOG_ERROR("=================== bridge send port=%d =============================", port_);
-        BridgeIO::getInstance()->onSend(ip_, port_, stream_id_, bridge_packet);
+        BridgeIO::getInstance()->onSend(endpoint_, std::move(bridge_packet));
     }
 }
 
@@ -27,6 +27,7 @@ public:
   int init(const std::string &ip,
            uint16_t port,
            const std::string &stream_id,
+           uint32_t handle,
            std::shared_ptr<erizo::IOWorker> io_worker,
            bool is_publisher,
            uint32_t video_ssrc,
@@ -35,6 +36,7 @@ public:
   void write(std::shared_ptr<DataPacket> data_packet);
   void read(std::shared_ptr<DataPacket> data_packet);
   void onRead(std::shared_ptr<DataPacket> bridge_packet);
+  uint32_t getHandle() { return handle_; }
 private:
   virtual int deliverAudioData_(std::shared_ptr<DataPacket> data_packet, const std::string &stream_id = "") override;
   virtual int deliverVideoData_(std::shared_ptr<DataPacket> data_packet, const std::string &stream_id = "") override;
@@ -51,9 +53,8 @@ private:
   std::string ip_;
   uint16_t port_;
   std::string stream_id_;
-
-  char send_buf_[MTU_SIZE];
-  char recv_buf_[MTU_SIZE];
+  uint32_t handle_;
+  BridgeEndpoint endpoint_;
 
   std::shared_ptr<erizo::IOWorker> io_worker_;
   std::shared_ptr<PacketBufferService> packet_buf_;
@@ -10,6 +10,7 @@
 
 #include "./SrtpChannel.h"
 #include "rtp/RtpHeaders.h"
+#include "rtp/RtpExtensionProcessor.h"
 #include "./LibNiceConnection.h"
 
 using erizo::TimeoutChecker;
@@ -170,8 +171,9 @@ void DtlsTransport::onIceData(packetPtr packet) {
     }
     return;
   } else if (this->getTransportState() == TRANSPORT_READY) {
-    std::shared_ptr<DataPacket> unprotect_packet = std::make_shared<DataPacket>(component_id,
-      data, len, VIDEO_PACKET, packet->received_time_ms);
+    // Packets coming from ICE are not shared with anyone else, unprotect them in place
+    std::shared_ptr<DataPacket> unprotect_packet = std::move(packet);
+    unprotect_packet->type = VIDEO_PACKET;
 
     if (dtlsRtcp != NULL && component_id == 2) {
       srtp = srtcp_.get();
@@ -206,7 +208,7 @@ void DtlsTransport::onCandidate(const CandidateInfo &candidate, IceConnection *c
   }
 }
 
-void DtlsTransport::write(char* data, int len) {
+void DtlsTransport::write(char* data, int len, packetType type, RtpExtensionProcessor *extension_processor) {
   if (ice_ == nullptr || !running_) {
     return;
   }
@@ -232,6 +234,9 @@ void DtlsTransport::write(char* data, int len) {
     } else {
       comp = 1;
 
+      if (extension_processor != nullptr) {
+        extension_processor->processRtpExtensions(protectBuf_, len, type);
+      }
       if (srtp && ice_->checkIceState() == IceState::READY) {
         if (srtp->protectRtp(protectBuf_, &length) < 0) {
           return;
@@ -251,7 +256,7 @@ void DtlsTransport::onDtlsPacket(DtlsSocketContext *ctx, const unsigned char* da
   bool is_rtcp = ctx == dtlsRtcp.get();
   int component_id = is_rtcp ? 2 : 1;
 
-  packetPtr packet = std::make_shared<DataPacket>(component_id, data, len);
+  packetPtr packet = makeDataPacket(component_id, data, len);
 
   if (is_rtcp) {
     writeDtlsPacket(dtlsRtcp.get(), packet);
@@ -32,7 +32,7 @@ class DtlsTransport : dtls::DtlsReceiver, public Transport {
   void close() override;
   void onIceData(packetPtr packet) override;
   void onCandidate(const CandidateInfo &candidate, IceConnection *conn) override;
-  void write(char* data, int len) override;
+  void write(char* data, int len, packetType type, RtpExtensionProcessor *extension_processor) override;
   void onDtlsPacket(dtls::DtlsSocketContext *ctx, const unsigned char* data, unsigned int len) override;
   void writeDtlsPacket(dtls::DtlsSocketContext *ctx, packetPtr packet);
   void onHandshakeCompleted(dtls::DtlsSocketContext *ctx, std::string clientKey, std::string serverKey,
@@ -62,7 +62,8 @@ void cb_new_selected_pair(NiceAgent *agent, guint stream_id, guint component_id,
 
 LibNiceConnection::LibNiceConnection(boost::shared_ptr<LibNiceInterface> libnice, const IceConfig& ice_config)
   : IceConnection{ice_config},
-    lib_nice_{libnice}, agent_{NULL}, loop_{NULL}, candsDelivered_{0}, receivedLastCandidate_{false} {
+    lib_nice_{libnice}, agent_{NULL}, context_{NULL}, loop_{NULL}, candsDelivered_{0},
+    receivedLastCandidate_{false} {
   #if !GLIB_CHECK_VERSION(2, 35, 0)
   g_type_init();
   #endif
@@ -81,6 +82,23 @@ void LibNiceConnection::close() {
     ELOG_DEBUG("%s message:closing", toLog());
     this->updateIceState(IceState::FINISHED);
   }
+  if (shared_loop_) {
+    // The loop belongs to the pool and keeps running: detach this agent on the loop thread so
+    // none of its callbacks can be dispatched after we return
+    listener_.reset();
+    NiceAgent* agent = agent_;
+    agent_ = NULL;
+    if (agent != NULL) {
+      ELOG_DEBUG("%s message: detaching agent from shared loop, this: %p", toLog(), this);
+      shared_loop_->invokeSync([this, agent] {
+        detachAgent(agent);
+      });
+    }
+    context_ = NULL;
+    shared_loop_.reset();
+    ELOG_DEBUG("%s message: closed, this: %p", toLog(), this);
+    return;
+  }
   if (loop_ != NULL) {
     ELOG_DEBUG("%s message:main loop quit", toLog());
     g_main_loop_quit(loop_);
@@ -110,6 +128,14 @@ void LibNiceConnection::close() {
   ELOG_DEBUG("%s message: closed, this: %p", toLog(), this);
 }
 
+void LibNiceConnection::detachAgent(NiceAgent* agent) {
+  for (unsigned int i = 1; i <= ice_config_.ice_components; i++) {
+    lib_nice_->NiceAgentAttachRecv(agent, 1, i, context_, NULL, NULL);
+  }
+  g_signal_handlers_disconnect_matched(G_OBJECT(agent), G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, this);
+  g_object_unref(agent);
+}
+
 void LibNiceConnection::onData(unsigned int component_id, char* buf, int len) {
   IceState state;
   {
@@ -117,7 +143,7 @@ void LibNiceConnection::onData(unsigned int component_id, char* buf, int len) {
     state = this->checkIceState();
   }
   if (state == IceState::READY) {
-    packetPtr packet (new DataPacket());
+    packetPtr packet = makeDataPacket();
     memcpy(packet->data, buf, len);
     packet->comp = component_id;
     packet->length = len;
@@ -144,13 +170,20 @@ void LibNiceConnection::start() {
     if (this->checkIceState() != INITIAL) {
       return;
     }
-    context_ = g_main_context_new();
+    shared_loop_ = GlibContextPool::getInstance()->getLessUsedLoop();
+    if (shared_loop_) {
+      context_ = shared_loop_->getContext();
+    } else {
+      context_ = g_main_context_new();
+    }
     ELOG_DEBUG("%s message: creating Nice Agent", toLog());
     nice_debug_enable(FALSE);
     // Create a nice agent
     agent_ = lib_nice_->NiceAgentNew(context_);
-    loop_ = g_main_loop_new(context_, FALSE);
-    m_Thread_ = boost::thread(&LibNiceConnection::mainLoop, this);
+    if (!shared_loop_) {
+      loop_ = g_main_loop_new(context_, FALSE);
+      m_Thread_ = boost::thread(&LibNiceConnection::mainLoop, this);
+    }
     GValue controllingMode = { 0 };
     g_value_init(&controllingMode, G_TYPE_BOOLEAN);
     g_value_set_boolean(&controllingMode, false);
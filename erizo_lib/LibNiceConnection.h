@@ -17,6 +17,7 @@
 #include "./SdpInfo.h"
 #include "./logger.h"
 #include "lib/LibNiceInterface.h"
+#include "thread/GlibContextPool.h"
 
 typedef struct _NiceAgent NiceAgent;
 typedef struct _GMainContext GMainContext;
@@ -45,7 +46,8 @@ class LibNiceConnection : public IceConnection {
 
   virtual ~LibNiceConnection();
   /**
-   * Starts Gathering candidates in a new thread.
+   * Starts Gathering candidates, on a shared GlibContextPool loop when the pool is started
+   * or in a new thread otherwise.
    */
   void start() override;
   bool setRemoteCandidates(const std::vector<CandidateInfo> &candidates, bool is_bundle) override;
@@ -64,12 +66,14 @@ class LibNiceConnection : public IceConnection {
 
  private:
   void mainLoop();
+  void detachAgent(NiceAgent* agent);
 
  private:
   boost::shared_ptr<LibNiceInterface> lib_nice_;
   NiceAgent* agent_;
   GMainContext* context_;
   GMainLoop* loop_;
+  std::shared_ptr<GlibLoop> shared_loop_;
 
   unsigned int candsDelivered_;
 
@@ -5,11 +5,18 @@
 #define ERIZO_SRC_ERIZO_MEDIADEFINITIONS_H_
 
 #include <boost/thread/mutex.hpp>
+#include <atomic>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 #include <algorithm>
 
 #include "lib/Clock.h"
 #include "lib/ClockUtils.h"
+#include "lib/PacketPool.h"
 
 namespace erizo {
 
@@ -19,9 +26,59 @@ enum packetType {
     OTHER_PACKET
 };
 
+/*
+ * Fixed-capacity list of the spatial/temporal layers a packet is compatible with.
+ * Stored inline so copying a DataPacket never allocates.
+ */
+class LayerList {
+ public:
+  static constexpr int kMaxLayers = 8;
+
+  LayerList() : size_{0} {}
+  LayerList(std::initializer_list<int> layers) : size_{0} {  // NOLINT
+    for (int layer : layers) {
+      push_back(layer);
+    }
+  }
+
+  void push_back(int layer) {
+    if (size_ < kMaxLayers) {
+      layers_[size_++] = layer;
+    }
+  }
+  void clear() { size_ = 0; }
+  int& back() { return layers_[size_ - 1]; }
+  int size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  int* begin() { return layers_; }
+  int* end() { return layers_ + size_; }
+  const int* begin() const { return layers_; }
+  const int* end() const { return layers_ + size_; }
+
+ private:
+  int layers_[kMaxLayers];
+  int size_;
+};
+
 struct DataPacket {
   DataPacket() = default;
 
+  // Only the used part of the payload buffer is copied
+  DataPacket(const DataPacket &other) :
+    comp{other.comp}, length{other.length}, type{other.type}, received_time_ms{other.received_time_ms},
+    compatible_spatial_layers{other.compatible_spatial_layers},
+    compatible_temporal_layers{other.compatible_temporal_layers},
+    is_keyframe{other.is_keyframe}, ending_of_layer_frame{other.ending_of_layer_frame},
+    picture_id{other.picture_id}, tl0_pic_idx{other.tl0_pic_idx}, codec{other.codec},
+    clock_rate{other.clock_rate} {
+      if (length > 0) {
+        memcpy(data, other.data, std::min(length, static_cast<int>(sizeof(data))));
+      }
+  }
+
+  DataPacket &operator=(const DataPacket &other) = default;
+
   DataPacket(int comp_, const char *data_, int length_, packetType type_, uint64_t received_time_ms_) :
     comp{comp_}, length{length_}, type{type_}, received_time_ms{received_time_ms_}, is_keyframe{false},
     ending_of_layer_frame{false}, picture_id{-1}, tl0_pic_idx{-1} {
@@ -41,41 +98,73 @@ struct DataPacket {
   }
 
   bool belongsToSpatialLayer(int spatial_layer_) {
-    std::vector<int>::iterator item = std::find(compatible_spatial_layers.begin(),
-                                              compatible_spatial_layers.end(),
-                                              spatial_layer_);
+    const int *item = std::find(compatible_spatial_layers.begin(),
+                                compatible_spatial_layers.end(),
+                                spatial_layer_);
 
     return item != compatible_spatial_layers.end();
   }
 
   bool belongsToTemporalLayer(int temporal_layer_) {
-    std::vector<int>::iterator item = std::find(compatible_temporal_layers.begin(),
-                                              compatible_temporal_layers.end(),
-                                              temporal_layer_);
+    const int *item = std::find(compatible_temporal_layers.begin(),
+                                compatible_temporal_layers.end(),
+                                temporal_layer_);
 
     return item != compatible_temporal_layers.end();
   }
 
-  int comp;
+  int comp = 0;
   char data[1500];
-  int length;
-  packetType type;
-  uint64_t received_time_ms;
-  std::vector<int> compatible_spatial_layers;
-  std::vector<int> compatible_temporal_layers;
-  bool is_keyframe;  // Note: It can be just a keyframe first packet in VP8
-  bool ending_of_layer_frame;
-  int picture_id;
-  int tl0_pic_idx;
+  int length = 0;
+  packetType type = OTHER_PACKET;
+  uint64_t received_time_ms = 0;
+  LayerList compatible_spatial_layers;
+  LayerList compatible_temporal_layers;
+  bool is_keyframe = false;  // Note: It can be just a keyframe first packet in VP8
+  bool ending_of_layer_frame = false;
+  int picture_id = -1;
+  int tl0_pic_idx = -1;
   std::string codec;
   unsigned int clock_rate = 0;
 };
 
+static_assert(sizeof(DataPacket) + 64 <= PacketPool::kBlockSize,
+              "DataPacket and its shared_ptr control block must fit in one pool block");
+
+/*
+ * Creates a DataPacket whose storage and reference count live in a single PacketPool block.
+ * Use this instead of std::make_shared<DataPacket> on every media path.
+ */
+template <typename... Args>
+inline std::shared_ptr<DataPacket> makeDataPacket(Args&&... args) {
+  return std::allocate_shared<DataPacket>(PacketAllocator<DataPacket>(), std::forward<Args>(args)...);
+}
+
+/*
+ * Publishers fan the same packet out to every subscriber, so a packet may be referenced by
+ * several pipelines at once. Handlers that rewrite bytes or fields on the outbound path call
+ * this first: it swaps in a private copy only when the packet is still shared.
+ */
+inline void ensureWritable(std::shared_ptr<DataPacket> &packet) {
+  if (packet && packet.use_count() > 1) {
+    packet = makeDataPacket(*packet);
+  }
+}
+
 class Monitor {
  protected:
     boost::mutex monitor_mutex_;
 };
 
+/*
+ * Bumped whenever a source or sink SSRC changes anywhere, so that SSRC routing tables built
+ * from them know they have to be rebuilt. SSRCs change at signaling time only.
+ */
+inline std::atomic<uint32_t>& ssrcGeneration() {
+    static std::atomic<uint32_t> generation{0};
+    return generation;
+}
+
 class MediaEvent {
  public:
   MediaEvent() = default;
@@ -134,7 +223,10 @@ class MediaSink: public virtual Monitor {
     }
     void setVideoSinkSSRC(uint32_t ssrc) {
         boost::mutex::scoped_lock lock(monitor_mutex_);
-        video_sink_ssrc_ = ssrc;
+        if (video_sink_ssrc_ != ssrc) {
+          video_sink_ssrc_ = ssrc;
+          ssrcGeneration()++;
+        }
     }
     uint32_t getAudioSinkSSRC() {
         boost::mutex::scoped_lock lock(monitor_mutex_);
@@ -142,7 +234,10 @@ class MediaSink: public virtual Monitor {
     }
     void setAudioSinkSSRC(uint32_t ssrc) {
         boost::mutex::scoped_lock lock(monitor_mutex_);
-        audio_sink_ssrc_ = ssrc;
+        if (audio_sink_ssrc_ != ssrc) {
+          audio_sink_ssrc_ = ssrc;
+          ssrcGeneration()++;
+        }
     }
     bool isVideoSinkSSRC(uint32_t ssrc) {
       return ssrc == video_sink_ssrc_;
@@ -212,9 +307,13 @@ class MediaSource: public virtual Monitor {
         boost::mutex::scoped_lock lock(monitor_mutex_);
         if (video_source_ssrc_list_.empty()) {
           video_source_ssrc_list_.push_back(ssrc);
+          ssrcGeneration()++;
           return;
         }
-        video_source_ssrc_list_[0] = ssrc;
+        if (video_source_ssrc_list_[0] != ssrc) {
+          video_source_ssrc_list_[0] = ssrc;
+          ssrcGeneration()++;
+        }
     }
     std::vector<uint32_t> getVideoSourceSSRCList() {
         boost::mutex::scoped_lock lock(monitor_mutex_);
@@ -222,7 +321,10 @@ class MediaSource: public virtual Monitor {
     }
     void setVideoSourceSSRCList(const std::vector<uint32_t>& new_ssrc_list) {
         boost::mutex::scoped_lock lock(monitor_mutex_);
-        video_source_ssrc_list_ = new_ssrc_list;
+        if (video_source_ssrc_list_ != new_ssrc_list) {
+          video_source_ssrc_list_ = new_ssrc_list;
+          ssrcGeneration()++;
+        }
     }
     uint32_t getAudioSourceSSRC() {
         boost::mutex::scoped_lock lock(monitor_mutex_);
@@ -230,7 +332,10 @@ class MediaSource: public virtual Monitor {
     }
     void setAudioSourceSSRC(uint32_t ssrc) {
         boost::mutex::scoped_lock lock(monitor_mutex_);
-        audio_source_ssrc_ = ssrc;
+        if (audio_source_ssrc_ != ssrc) {
+          audio_source_ssrc_ = ssrc;
+          ssrcGeneration()++;
+        }
     }
 
     bool isVideoSourceSSRC(uint32_t ssrc) {
@@ -63,7 +63,9 @@ MediaStream::MediaStream(std::shared_ptr<Worker> worker,
                                               is_publisher_{is_publisher},
                                               simulcast_{false},
                                               bitrate_from_max_quality_layer_{0},
-                                              video_bitrate_{0}
+                                              video_bitrate_{0},
+                                              latency_stats_{false},
+                                              latency_stats_enabled_{false}
 {
     setVideoSinkSSRC(kDefaultVideoSinkSSRC);
     setAudioSinkSSRC(kDefaultAudioSinkSSRC);
@@ -395,14 +397,54 @@ void MediaStream::initializePipeline()
 
     pipeline_->addFront(std::make_shared<PacketWriter>(this));
     pipeline_->finalize();
+    if (latency_stats_)
+    {
+        read_queue_latency_.reset(new LatencyHistogram());
+        write_queue_latency_.reset(new LatencyHistogram());
+        pipeline_->enableLatencyStats();
+        latency_stats_enabled_ = true;
+    }
     pipeline_initialized_ = true;
 }
 
+static void insertLatencyStats(StatNode &node, const LatencyHistogram &histogram)
+{
+    // microseconds
+    node.insertStat("count", CumulativeStat{histogram.count()});
+    node.insertStat("p50", CumulativeStat{histogram.percentile(50) / 1000});
+    node.insertStat("p90", CumulativeStat{histogram.percentile(90) / 1000});
+    node.insertStat("p99", CumulativeStat{histogram.percentile(99) / 1000});
+    node.insertStat("max", CumulativeStat{histogram.max() / 1000});
+}
+
+void MediaStream::updateLatencyStats()
+{
+    if (!latency_stats_enabled_)
+    {
+        return;
+    }
+    StatNode &latency = stats_->getNode()["pipelineLatencyUs"];
+    insertLatencyStats(latency["readQueue"], *read_queue_latency_);
+    insertLatencyStats(latency["writeQueue"], *write_queue_latency_);
+    pipeline_->forEachLatencyStats([&latency](const std::string &name,
+                                              const LatencyHistogram *read_latency,
+                                              const LatencyHistogram *write_latency) {
+        if (read_latency)
+        {
+            insertLatencyStats(latency[name]["read"], *read_latency);
+        }
+        if (write_latency)
+        {
+            insertLatencyStats(latency[name]["write"], *write_latency);
+        }
+    });
+}
+
 int MediaStream::deliverAudioData_(std::shared_ptr<DataPacket> audio_packet, const std::string &stream_id)
 {
     if (audio_enabled_)
     {
-        sendPacketAsync(std::make_shared<DataPacket>(*audio_packet));
+        sendPacketAsync(audio_packet);
     }
     return audio_packet->length;
 }
@@ -411,7 +453,7 @@ int MediaStream::deliverVideoData_(std::shared_ptr<DataPacket> video_packet, con
 {
     if (video_enabled_)
     {
-        sendPacketAsync(std::make_shared<DataPacket>(*video_packet));
+        sendPacketAsync(video_packet);
     }
     return video_packet->length;
 }
@@ -474,7 +516,7 @@ void MediaStream::onTransportData(std::shared_ptr<DataPacket> incoming_packet, T
         return;
     }
 
-    std::shared_ptr<DataPacket> packet = std::make_shared<DataPacket>(*incoming_packet);
+    std::shared_ptr<DataPacket> packet = makeDataPacket(*incoming_packet);
 
     if (transport->mediaType == AUDIO_TYPE)
     {
@@ -485,8 +527,13 @@ void MediaStream::onTransportData(std::shared_ptr<DataPacket> incoming_packet, T
         packet->type = VIDEO_PACKET;
     }
     auto stream_ptr = shared_from_this();
+    int64_t enqueued = latency_stats_enabled_ ? LatencyHistogram::now() : 0;
 
-    worker_->task([stream_ptr, packet] {
+    worker_->task([stream_ptr, packet, enqueued] {
+        if (enqueued != 0)
+        {
+            stream_ptr->read_queue_latency_->record(LatencyHistogram::now() - enqueued);
+        }
         if (!stream_ptr->pipeline_initialized_)
         {
             ELOG_DEBUG("%s message: Pipeline not initialized yet.", stream_ptr->toLog());
@@ -523,7 +570,7 @@ void MediaStream::onTransportData(std::shared_ptr<DataPacket> incoming_packet, M
         return;
     }
 
-    std::shared_ptr<DataPacket> packet = std::make_shared<DataPacket>(*incoming_packet);
+    std::shared_ptr<DataPacket> packet = makeDataPacket(*incoming_packet);
 
     if (media_type == AUDIO_TYPE)
     {
@@ -534,8 +581,13 @@ void MediaStream::onTransportData(std::shared_ptr<DataPacket> incoming_packet, M
         packet->type = VIDEO_PACKET;
     }
     auto stream_ptr = shared_from_this();
+    int64_t enqueued = latency_stats_enabled_ ? LatencyHistogram::now() : 0;
 
-    worker_->task([stream_ptr, packet] {
+    worker_->task([stream_ptr, packet, enqueued] {
+        if (enqueued != 0)
+        {
+            stream_ptr->read_queue_latency_->record(LatencyHistogram::now() - enqueued);
+        }
         if (!stream_ptr->pipeline_initialized_)
         {
             ELOG_ERROR("onTransportData Pipeline not initialized yet");
@@ -674,7 +726,7 @@ int MediaStream::sendPLI()
     thePLI.setLength(2);
     char *buf = reinterpret_cast<char *>(&thePLI);
     int len = (thePLI.getLength() + 1) * 4;
-    sendPacketAsync(std::make_shared<DataPacket>(0, buf, len, VIDEO_PACKET));
+    sendPacketAsync(makeDataPacket(0, buf, len, VIDEO_PACKET));
     return len;
 }
 
@@ -698,7 +750,7 @@ void MediaStream::sendPacketAsync(std::shared_ptr<DataPacket> packet)
     if (packet->comp == -1)
     {
         sending_ = false;
-        auto p = std::make_shared<DataPacket>();
+        auto p = makeDataPacket();
         p->comp = -1;
         worker_->task([stream_ptr, p] {
             stream_ptr->sendPacket(p);
@@ -706,8 +758,13 @@ void MediaStream::sendPacketAsync(std::shared_ptr<DataPacket> packet)
         return;
     }
 
-    changeDeliverPayloadType(packet.get(), packet->type);
-    worker_->task([stream_ptr, packet] {
+    changeDeliverPayloadType(packet, packet->type);
+    int64_t enqueued = latency_stats_enabled_ ? LatencyHistogram::now() : 0;
+    worker_->task([stream_ptr, packet, enqueued] {
+        if (enqueued != 0)
+        {
+            stream_ptr->write_queue_latency_->record(LatencyHistogram::now() - enqueued);
+        }
         stream_ptr->sendPacket(packet);
     });
 }
@@ -817,16 +874,25 @@ WebRTCEvent MediaStream::getCurrentState()
 void MediaStream::getJSONStats(std::function<void(std::string)> callback)
 {
     asyncTask([callback](std::shared_ptr<MediaStream> stream) {
+        stream->updateLatencyStats();
         std::string requested_stats = stream->stats_->getStats();
         //  ELOG_DEBUG("%s message: Stats, stats: %s", stream->toLog(), requested_stats.c_str());
         callback(requested_stats);
     });
 }
 
-void MediaStream::changeDeliverPayloadType(DataPacket *dp, packetType type)
+void MediaStream::getFlatStats(std::function<void(FlatStats)> callback)
+{
+    asyncTask([callback](std::shared_ptr<MediaStream> stream) {
+        stream->updateLatencyStats();
+        callback(stream->stats_->getFlatStats());
+    });
+}
+
+void MediaStream::changeDeliverPayloadType(std::shared_ptr<DataPacket> &packet, packetType type)
 {
-    RtpHeader *h = reinterpret_cast<RtpHeader *>(dp->data);
-    RtcpHeader *chead = reinterpret_cast<RtcpHeader *>(dp->data);
+    RtpHeader *h = reinterpret_cast<RtpHeader *>(packet->data);
+    RtcpHeader *chead = reinterpret_cast<RtcpHeader *>(packet->data);
     if (!chead->isRtcp())
     {
         int internalPT = h->getPayloadType();
@@ -841,6 +907,9 @@ void MediaStream::changeDeliverPayloadType(DataPacket *dp, packetType type)
         }
         if (internalPT != externalPT)
         {
+            // The packet may be shared with the publisher's other subscribers
+            ensureWritable(packet);
+            h = reinterpret_cast<RtpHeader *>(packet->data);
             h->setPayloadType(externalPT);
         }
     }
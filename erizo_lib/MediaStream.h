@@ -20,6 +20,7 @@
 #include "rtp/RtcpProcessor.h"
 #include "rtp/RtpExtensionProcessor.h"
 #include "lib/Clock.h"
+#include "lib/LatencyHistogram.h"
 #include "pipeline/Handler.h"
 #include "pipeline/HandlerManager.h"
 #include "pipeline/Service.h"
@@ -104,6 +105,8 @@ class MediaStream: public MediaSink, public MediaSource, public FeedbackSink,
   }
 
   void getJSONStats(std::function<void(std::string)> callback);
+  // Numeric stats by path, gathered on the stream's worker thread
+  void getFlatStats(std::function<void(FlatStats)> callback);
 
   virtual void onTransportData(std::shared_ptr<DataPacket> packet, Transport *transport);
   virtual void onTransportData(std::shared_ptr<DataPacket> packet, MediaType media_type);
@@ -143,6 +146,11 @@ class MediaStream: public MediaSink, public MediaSource, public FeedbackSink,
   virtual bool isSimulcast() { return simulcast_; }
   void setSimulcast(bool simulcast) { simulcast_ = simulcast; }
 
+  // Opt-in per handler and worker queue latency histograms, must be set before init()
+  void setLatencyStats(bool enabled) { latency_stats_ = enabled; }
+  // Copies the latency histograms into the stats tree, worker thread only
+  void updateLatencyStats();
+
   RtpExtensionProcessor& getRtpExtensionProcessor() { return connection_->getRtpExtensionProcessor(); }
   std::shared_ptr<Worker> getWorker() { return worker_; }
 
@@ -173,7 +181,7 @@ class MediaStream: public MediaSink, public MediaSource, public FeedbackSink,
   void transferLayerStats(std::string spatial, std::string temporal);
   void transferMediaStats(std::string target_node, std::string source_parent, std::string source_node);
 
-  void changeDeliverPayloadType(DataPacket *dp, packetType type);
+  void changeDeliverPayloadType(std::shared_ptr<DataPacket> &packet, packetType type);
   // parses incoming payload type, replaces occurence in buf
 
  private:
@@ -214,6 +222,11 @@ class MediaStream: public MediaSink, public MediaSource, public FeedbackSink,
   std::atomic_bool simulcast_;
   std::atomic<uint64_t> bitrate_from_max_quality_layer_;
   std::atomic<uint32_t> video_bitrate_;
+
+  bool latency_stats_;
+  std::atomic_bool latency_stats_enabled_;
+  std::unique_ptr<LatencyHistogram> read_queue_latency_;
+  std::unique_ptr<LatencyHistogram> write_queue_latency_;
  protected:
   std::shared_ptr<SdpInfo> remote_sdp_;
 };
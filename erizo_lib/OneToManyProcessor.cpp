@@ -12,7 +12,8 @@
 
 namespace erizo {
   DEFINE_LOGGER(OneToManyProcessor, "OneToManyProcessor");
-  OneToManyProcessor::OneToManyProcessor() : feedbackSink_{nullptr} {
+  OneToManyProcessor::OneToManyProcessor() : feedbackSink_{nullptr},
+      delivery_list_{std::make_shared<const sink_list>()} {
     ELOG_DEBUG("OneToManyProcessor constructor");
   }
 
@@ -23,15 +24,9 @@ namespace erizo {
     if (audio_packet->length <= 0)
       return 0;
 
-    boost::unique_lock<boost::mutex> lock(monitor_mutex_);
-    if (subscribers.empty())
-      return 0;
-    RtcpHeader* head = reinterpret_cast<RtcpHeader*>(audio_packet->data);
-    std::map<std::string, std::shared_ptr<MediaSink>>::iterator it;
-    for (it = subscribers.begin(); it != subscribers.end(); ++it) {
-      if ((*it).second != nullptr) {
-        (*it).second->deliverAudioData(audio_packet, stream_id);
-      }
+    std::shared_ptr<const sink_list> sinks = getDeliveryList();
+    for (const sink_ptr &sink : *sinks) {
+      sink->deliverAudioData(audio_packet, stream_id);
     }
 
     return 0;
@@ -49,14 +44,9 @@ namespace erizo {
       }
       return 0;
     }
-    boost::unique_lock<boost::mutex> lock(monitor_mutex_);
-    if (subscribers.empty())
-      return 0;
-    std::map<std::string, std::shared_ptr<MediaSink>>::iterator it;
-    for (it = subscribers.begin(); it != subscribers.end(); ++it) {
-      if ((*it).second != nullptr) {
-        (*it).second->deliverVideoData(video_packet, stream_id);
-      }
+    std::shared_ptr<const sink_list> sinks = getDeliveryList();
+    for (const sink_ptr &sink : *sinks) {
+      sink->deliverVideoData(video_packet, stream_id);
     }
     return 0;
   }
@@ -76,14 +66,9 @@ namespace erizo {
   }
 
   int OneToManyProcessor::deliverEvent_(MediaEventPtr event) {
-    boost::unique_lock<boost::mutex> lock(monitor_mutex_);
-    if (subscribers.empty())
-      return 0;
-    std::map<std::string, std::shared_ptr<MediaSink>>::iterator it;
-    for (it = subscribers.begin(); it != subscribers.end(); ++it) {
-      if ((*it).second != nullptr) {
-        (*it).second->deliverEvent(event);
-      }
+    std::shared_ptr<const sink_list> sinks = getDeliveryList();
+    for (const sink_ptr &sink : *sinks) {
+      sink->deliverEvent(event);
     }
     return 0;
   }
@@ -109,11 +94,14 @@ namespace erizo {
         this->subscribers.erase(peer_id);
     }
     this->subscribers[peer_id] = subscriber_stream;
+    publishSubscribers();
   }
 
   std::shared_ptr<MediaSink> OneToManyProcessor::getSubscriber(const std::string& peer_id){
-    if (this->subscribers.find(peer_id) != subscribers.end()) {
-        return this->subscribers[peer_id];
+    boost::mutex::scoped_lock lock(monitor_mutex_);
+    auto it = subscribers.find(peer_id);
+    if (it != subscribers.end()) {
+        return it->second;
     }
     return nullptr;
   }
@@ -123,6 +111,7 @@ namespace erizo {
     boost::mutex::scoped_lock lock(monitor_mutex_);
     if (this->subscribers.find(peer_id) != subscribers.end()) {
       this->subscribers.erase(peer_id);
+      publishSubscribers();
     }
   }
 
@@ -146,7 +135,24 @@ namespace erizo {
       subscribers.erase(it++);
     }
     subscribers.clear();
+    publishSubscribers();
     ELOG_DEBUG("ClosedAll media in this OneToMany");
   }
 
+  // Must be called with monitor_mutex_ held
+  void OneToManyProcessor::publishSubscribers() {
+    auto sinks = std::make_shared<sink_list>();
+    sinks->reserve(subscribers.size());
+    for (const auto &subscriber : subscribers) {
+      if (subscriber.second != nullptr) {
+        sinks->push_back(subscriber.second);
+      }
+    }
+    std::atomic_store(&delivery_list_, std::shared_ptr<const sink_list>(std::move(sinks)));
+  }
+
+  std::shared_ptr<const OneToManyProcessor::sink_list> OneToManyProcessor::getDeliveryList() const {
+    return std::atomic_load(&delivery_list_);
+  }
+
 }  // namespace erizo
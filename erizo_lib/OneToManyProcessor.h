@@ -6,7 +6,9 @@
 #define ERIZO_SRC_ERIZO_ONETOMANYPROCESSOR_H_
 
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 #include <future>  // NOLINT
 
 #include "./MediaDefinitions.h"
@@ -56,13 +58,19 @@ class OneToManyProcessor : public MediaSink, public FeedbackSink {
 
  private:
   typedef std::shared_ptr<MediaSink> sink_ptr;
+  typedef std::vector<sink_ptr> sink_list;
   FeedbackSink* feedbackSink_;
+  // Immutable snapshot of subscribers, rebuilt under monitor_mutex_ on every change and read
+  // lock-free (std::atomic_load) from the media path
+  std::shared_ptr<const sink_list> delivery_list_;
 
   int deliverAudioData_(std::shared_ptr<DataPacket> audio_packet, const std::string &stream_id = "") override;
   int deliverVideoData_(std::shared_ptr<DataPacket> video_packet, const std::string &stream_id = "") override;
   int deliverFeedback_(std::shared_ptr<DataPacket> fb_packet, const std::string &stream_id = "") override;
   int deliverEvent_(MediaEventPtr event) override;
   void closeAll();
+  void publishSubscribers();
+  std::shared_ptr<const sink_list> getDeliveryList() const;
 };
 
 }  // namespace erizo
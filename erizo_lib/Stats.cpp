@@ -28,6 +28,12 @@ namespace erizo {
     return root_.toString();
   }
 
+  FlatStats Stats::getFlatStats() {
+    FlatStats stats;
+    root_.flatten("", &stats);
+    return stats;
+  }
+
   void Stats::setStatsListener(MediaStreamStatsListener* listener) {
     boost::mutex::scoped_lock lock(listener_mutex_);
     listener_ = listener;
@@ -28,6 +28,7 @@ class Stats : public Service {
   StatNode& getNode();
 
   std::string getStats();
+  FlatStats getFlatStats();
 
   void setStatsListener(MediaStreamStatsListener* listener);
   void sendStats();
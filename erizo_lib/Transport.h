@@ -25,6 +25,7 @@ enum TransportState
 namespace erizo
 {
 class Transport;
+class RtpExtensionProcessor;
 
 class TransportListener
 {
@@ -49,7 +50,9 @@ public:
     virtual void updateIceState(IceState state, IceConnection *conn) = 0;
     virtual void onIceData(packetPtr packet) = 0;
     virtual void onCandidate(const CandidateInfo &candidate, IceConnection *conn) = 0;
-    virtual void write(char *data, int len) = 0;
+    // data may be shared with other connections: per-connection header extensions are stamped by
+    // extension_processor (if any) on the transport's own copy, right before protection
+    virtual void write(char *data, int len, packetType type, RtpExtensionProcessor *extension_processor) = 0;
     virtual void processLocalSdp(SdpInfo *localSdp_) = 0;
     virtual void start() = 0;
     virtual void close() = 0;
@@ -78,6 +78,7 @@ void WebRtcConnection::syncClose()
     }
     sending_ = false;
     media_streams_.clear();
+    invalidateSsrcRoutes();
     if (video_transport_.get())
     {
         video_transport_->close();
@@ -175,6 +176,7 @@ void WebRtcConnection::addMediaStream(std::shared_ptr<MediaStream> media_stream)
     asyncTask([media_stream](std::shared_ptr<WebRtcConnection> connection) {
         ELOG_DEBUG("%s message: Adding mediaStream, id: %s", connection->toLog(), media_stream->getId().c_str());
         connection->media_streams_.push_back(media_stream);
+        connection->invalidateSsrcRoutes();
         if (connection->media_streams_.size() >= 1)
         {
             connection->remote_sdp_->is_publisher_ = media_stream->isPublisher();
@@ -209,6 +211,7 @@ void WebRtcConnection::removeMediaStream(const std::string &stream_id)
                                                             }
                                                             return isStream;
                                                         }));
+        connection->invalidateSsrcRoutes();
     });
 }
 
@@ -217,6 +220,50 @@ void WebRtcConnection::forEachMediaStream(std::function<void(const std::shared_p
     std::for_each(media_streams_.begin(), media_streams_.end(), func);
 }
 
+std::shared_ptr<const WebRtcConnection::SsrcRoutes> WebRtcConnection::getSsrcRoutes()
+{
+    // Read before the SSRCs and media_streams_ are, so that a change racing with a rebuild
+    // triggers another one
+    uint32_t routes_generation = ssrc_routes_generation_.load();
+    uint32_t generation = ssrcGeneration();
+    std::shared_ptr<const SsrcRoutes> routes = std::atomic_load(&ssrc_routes_);
+    if (routes && routes->generation == generation && routes->routes_generation == routes_generation)
+    {
+        return routes;
+    }
+
+    std::shared_ptr<SsrcRoutes> rebuilt = std::make_shared<SsrcRoutes>();
+    rebuilt->generation = generation;
+    rebuilt->routes_generation = routes_generation;
+    auto add_route = [&rebuilt](uint32_t ssrc, const std::shared_ptr<MediaStream> &media_stream) {
+        std::vector<std::shared_ptr<MediaStream>> &streams = rebuilt->streams[ssrc];
+        if (std::find(streams.begin(), streams.end(), media_stream) == streams.end())
+        {
+            streams.push_back(media_stream);
+        }
+    };
+    forEachMediaStream([&add_route](const std::shared_ptr<MediaStream> &media_stream) {
+        for (uint32_t ssrc : media_stream->getVideoSourceSSRCList())
+        {
+            add_route(ssrc, media_stream);
+        }
+        add_route(media_stream->getAudioSourceSSRC(), media_stream);
+        add_route(media_stream->getVideoSinkSSRC(), media_stream);
+        add_route(media_stream->getAudioSinkSSRC(), media_stream);
+    });
+    routes = rebuilt;
+    std::atomic_store(&ssrc_routes_, routes);
+    return routes;
+}
+
+void WebRtcConnection::invalidateSsrcRoutes()
+{
+    // A rebuild in flight may still store a table of the old streams, tagged with the old
+    // generation, which the next getSsrcRoutes() then throws away
+    ssrc_routes_generation_++;
+    std::atomic_store(&ssrc_routes_, std::shared_ptr<const SsrcRoutes>());
+}
+
 void WebRtcConnection::forEachMediaStreamAsync(std::function<void(const std::shared_ptr<MediaStream> &)> func)
 {
     std::for_each(media_streams_.begin(), media_streams_.end(),
@@ -594,16 +641,23 @@ void WebRtcConnection::onCandidate(const CandidateInfo &cand, Transport *transpo
 void WebRtcConnection::onREMBFromTransport(RtcpHeader *chead, Transport *transport)
 {
     std::vector<std::shared_ptr<MediaStream>> streams;
+    std::shared_ptr<const SsrcRoutes> routes = getSsrcRoutes();
 
     for (uint8_t index = 0; index < chead->getREMBNumSSRC(); index++)
     {
         uint32_t ssrc_feed = chead->getREMBFeedSSRC(index);
-        forEachMediaStream([ssrc_feed, &streams](const std::shared_ptr<MediaStream> &media_stream) {
+        auto route = routes->streams.find(ssrc_feed);
+        if (route == routes->streams.end())
+        {
+            continue;
+        }
+        for (const std::shared_ptr<MediaStream> &media_stream : route->second)
+        {
             if (media_stream->isSinkSSRC(ssrc_feed))
             {
                 streams.push_back(media_stream);
             }
-        });
+        }
     }
 
     distributor_->distribute(chead->getREMBBitRate(), chead->getSSRC(), streams, transport);
@@ -611,22 +665,64 @@ void WebRtcConnection::onREMBFromTransport(RtcpHeader *chead, Transport *transpo
 
 void WebRtcConnection::onRtcpFromTransport(std::shared_ptr<DataPacket> packet, Transport *transport)
 {
-    RtpUtils::forEachRtcpBlock(packet, [this, packet, transport](RtcpHeader *chead) {
+    std::shared_ptr<const SsrcRoutes> routes = getSsrcRoutes();
+    static const std::vector<std::shared_ptr<MediaStream>> kNoStreams;
+
+    // First pass over views of the blocks: when they all go to the same streams, which is the
+    // common case, the compound packet is handed over as it is
+    const std::vector<std::shared_ptr<MediaStream>> *common_streams = nullptr;
+    bool split = false;
+    RtpUtils::forEachRtcpBlock(packet, [&](RtcpHeader *chead) {
+        if (chead->isREMB())
+        {
+            split = true;
+            return;
+        }
+        uint32_t ssrc = chead->isFeedback() ? chead->getSourceSSRC() : chead->getSSRC();
+        auto route = routes->streams.find(ssrc);
+        const std::vector<std::shared_ptr<MediaStream>> *streams =
+            route == routes->streams.end() ? &kNoStreams : &route->second;
+        if (!common_streams)
+        {
+            common_streams = streams;
+        }
+        else if (*common_streams != *streams)
+        {
+            split = true;
+        }
+    });
+
+    if (!split)
+    {
+        if (common_streams)
+        {
+            for (const std::shared_ptr<MediaStream> &media_stream : *common_streams)
+            {
+                media_stream->onTransportData(packet, transport);
+            }
+        }
+        return;
+    }
+
+    RtpUtils::forEachRtcpBlock(packet, [this, packet, transport, &routes](RtcpHeader *chead) {
         uint32_t ssrc = chead->isFeedback() ? chead->getSourceSSRC() : chead->getSSRC();
         if (chead->isREMB())
         {
             onREMBFromTransport(chead, transport);
             return;
         }
-        std::shared_ptr<DataPacket> rtcp = std::make_shared<DataPacket>(*packet);
+        auto route = routes->streams.find(ssrc);
+        if (route == routes->streams.end())
+        {
+            return;
+        }
+        std::shared_ptr<DataPacket> rtcp = makeDataPacket(*packet);
         rtcp->length = (ntohs(chead->length) + 1) * 4;
         std::memcpy(rtcp->data, chead, rtcp->length);
-        forEachMediaStream([rtcp, transport, ssrc](const std::shared_ptr<MediaStream> &media_stream) {
-            if (media_stream->isSourceSSRC(ssrc) || media_stream->isSinkSSRC(ssrc))
-            {
-                media_stream->onTransportData(rtcp, transport);
-            }
-        });
+        for (const std::shared_ptr<MediaStream> &media_stream : route->second)
+        {
+            media_stream->onTransportData(rtcp, transport);
+        }
     });
 }
 
@@ -647,12 +743,16 @@ void WebRtcConnection::onTransportData(std::shared_ptr<DataPacket> packet, Trans
     {
         RtpHeader *head = reinterpret_cast<RtpHeader *>(buf);
         uint32_t ssrc = head->getSSRC();
-        forEachMediaStream([packet, transport, ssrc](const std::shared_ptr<MediaStream> &media_stream) {
-            if (media_stream->isSourceSSRC(ssrc) || media_stream->isSinkSSRC(ssrc))
-            {
-                media_stream->onTransportData(packet, transport);
-            }
-        });
+        std::shared_ptr<const SsrcRoutes> routes = getSsrcRoutes();
+        auto route = routes->streams.find(ssrc);
+        if (route == routes->streams.end())
+        {
+            return;
+        }
+        for (const std::shared_ptr<MediaStream> &media_stream : route->second)
+        {
+            media_stream->onTransportData(packet, transport);
+        }
     }
 }
 
@@ -862,8 +962,7 @@ void WebRtcConnection::syncWrite(std::shared_ptr<DataPacket> packet)
     {
         return;
     }
-    this->extension_processor_.processRtpExtensions(packet);
-    transport->write(packet->data, packet->length);
+    transport->write(packet->data, packet->length, packet->type, &extension_processor_);
 }
 
 void WebRtcConnection::setTransport(std::shared_ptr<Transport> transport)
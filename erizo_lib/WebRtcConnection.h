@@ -3,8 +3,10 @@
 
 #include <boost/thread/mutex.hpp>
 
+#include <atomic>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 #include "./logger.h"
@@ -160,6 +162,15 @@ class WebRtcConnection: public TransportListener, public LogContext,
   void trackTransportInfo();
   void onRtcpFromTransport(std::shared_ptr<DataPacket> packet, Transport *transport);
   void onREMBFromTransport(RtcpHeader *chead, Transport *transport);
+
+  // Streams sending or receiving each SSRC, so that demuxing a packet is a single lookup
+  struct SsrcRoutes {
+    uint32_t generation = 0;
+    uint32_t routes_generation = 0;
+    std::unordered_map<uint32_t, std::vector<std::shared_ptr<MediaStream>>> streams;
+  };
+  std::shared_ptr<const SsrcRoutes> getSsrcRoutes();
+  void invalidateSsrcRoutes();
   void maybeNotifyWebRtcConnectionEvent(const WebRTCEvent& event, const std::string& message,
         const std::string& stream_id = "");
 
@@ -188,6 +199,11 @@ class WebRtcConnection: public TransportListener, public LogContext,
   std::shared_ptr<Worker> worker_;
   std::shared_ptr<IOWorker> io_worker_;
   std::vector<std::shared_ptr<MediaStream>> media_streams_;
+  // Rebuilt when media_streams_ or any SSRC (see ssrcGeneration()) changes, read with
+  // std::atomic_load. invalidateSsrcRoutes() bumps ssrc_routes_generation_, so a table built
+  // from the streams as they were before cannot pass for current, even if it is stored later.
+  std::shared_ptr<const SsrcRoutes> ssrc_routes_;
+  std::atomic<uint32_t> ssrc_routes_generation_{0};
   std::shared_ptr<SdpInfo> remote_sdp_;
   std::shared_ptr<SdpInfo> local_sdp_;
   bool audio_muted_;
@@ -0,0 +1,37 @@
+#include "lib/LatencyHistogram.h"
+
+namespace erizo {
+
+constexpr int LatencyHistogram::kSubBucketBits;
+constexpr uint64_t LatencyHistogram::kSubBuckets;
+constexpr int LatencyHistogram::kMaxMagnitude;
+constexpr int LatencyHistogram::kBuckets;
+
+LatencyHistogram::LatencyHistogram() : count_{0}, max_{0} {
+  for (int bucket = 0; bucket < kBuckets; bucket++) {
+    buckets_[bucket].store(0, std::memory_order_relaxed);
+  }
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const {
+  uint64_t total = count();
+  if (total == 0) {
+    return 0;
+  }
+  uint64_t rank = static_cast<uint64_t>(total * percent / 100.0);
+  if (rank == 0) {
+    rank = 1;
+  }
+  uint64_t seen = 0;
+  for (int bucket = 0; bucket < kBuckets - 1; bucket++) {
+    seen += buckets_[bucket].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      uint64_t upper = bucketLowerBound(bucket + 1) - 1;
+      uint64_t max_seen = max();
+      return upper < max_seen ? upper : max_seen;
+    }
+  }
+  return max();
+}
+
+}  // namespace erizo
@@ -0,0 +1,71 @@
+#ifndef ERIZO_SRC_ERIZO_LIB_LATENCYHISTOGRAM_H_
+#define ERIZO_SRC_ERIZO_LIB_LATENCYHISTOGRAM_H_
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+
+namespace erizo {
+
+/*
+ * Log-linear latency histogram in nanoseconds, HDR style: every power of two is split into
+ * kSubBuckets linear buckets, so any recorded value is known within 1/kSubBuckets (12.5%).
+ * Values above ~17s land in the last bucket. record() is a relaxed atomic increment, so one
+ * thread can record while others read.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 3;
+  static constexpr uint64_t kSubBuckets = 1 << kSubBucketBits;
+  static constexpr int kMaxMagnitude = 34;
+  static constexpr int kBuckets = (kMaxMagnitude - kSubBucketBits + 2) * kSubBuckets;
+
+  LatencyHistogram();
+
+  static int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  void record(int64_t nanoseconds) {
+    uint64_t value = nanoseconds > 0 ? nanoseconds : 0;
+    buckets_[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+  // Upper edge of the bucket holding the given percentile (0-100), 0 when empty
+  uint64_t percentile(double percent) const;
+
+ private:
+  static int bucketFor(uint64_t value) {
+    if (value < kSubBuckets) {
+      return static_cast<int>(value);
+    }
+    int magnitude = 63 - __builtin_clzll(value);
+    if (magnitude > kMaxMagnitude) {
+      return kBuckets - 1;
+    }
+    int shift = magnitude - kSubBucketBits;
+    return (shift + 1) * kSubBuckets + ((value >> shift) & (kSubBuckets - 1));
+  }
+
+  static uint64_t bucketLowerBound(int bucket) {
+    if (bucket < static_cast<int>(kSubBuckets)) {
+      return bucket;
+    }
+    int shift = bucket / kSubBuckets - 1;
+    return (kSubBuckets + bucket % kSubBuckets) << shift;
+  }
+
+  std::atomic<uint64_t> buckets_[kBuckets];
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> max_;
+};
+
+}  // namespace erizo
+#endif  // ERIZO_SRC_ERIZO_LIB_LATENCYHISTOGRAM_H_
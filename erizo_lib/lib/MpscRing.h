@@ -0,0 +1,92 @@
+#ifndef ERIZO_SRC_ERIZO_LIB_MPSCRING_H_
+#define ERIZO_SRC_ERIZO_LIB_MPSCRING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace erizo {
+
+/*
+ * Bounded lock-free ring for many producers and a single consumer (Vyukov's bounded queue).
+ * Each cell carries a sequence number, so producers only contend on one CAS and the consumer
+ * never touches a shared counter. push() fails instead of blocking when the ring is full.
+ */
+template <typename T>
+class MpscRing {
+ public:
+  // capacity is rounded up to a power of two
+  explicit MpscRing(size_t capacity) : enqueue_pos_{0}, dequeue_pos_{0} {
+    size_t size = 2;
+    while (size < capacity) {
+      size *= 2;
+    }
+    mask_ = size - 1;
+    cells_.reset(new Cell[size]);
+    for (size_t index = 0; index < size; index++) {
+      cells_[index].sequence.store(index, std::memory_order_relaxed);
+    }
+  }
+
+  // value is left untouched when the ring is full
+  bool push(T&& value) {
+    return emplace(std::move(value));
+  }
+
+  bool push(const T& value) {
+    return emplace(value);
+  }
+
+  // Consumer thread only
+  bool pop(T* value) {
+    Cell* cell = &cells_[dequeue_pos_ & mask_];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeue_pos_ + 1) < 0) {
+      return false;
+    }
+    *value = std::move(cell->value);
+    cell->value = T();
+    cell->sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+    dequeue_pos_++;
+    return true;
+  }
+
+ private:
+  template <typename U>
+  bool emplace(U&& value) {  // NOLINT
+    Cell* cell;
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+      cell = &cells_[pos & mask_];
+      size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->value = std::forward<U>(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  alignas(64) std::atomic<size_t> enqueue_pos_;
+  alignas(64) size_t dequeue_pos_;
+};
+
+}  // namespace erizo
+#endif  // ERIZO_SRC_ERIZO_LIB_MPSCRING_H_
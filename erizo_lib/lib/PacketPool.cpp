@@ -0,0 +1,121 @@
+#include "lib/PacketPool.h"
+
+#include <mutex>  // NOLINT
+#include <vector>
+
+namespace erizo {
+
+constexpr size_t PacketPool::kBlockSize;
+constexpr size_t PacketPool::kBlocksPerSlab;
+constexpr size_t PacketPool::kBatchSize;
+constexpr size_t PacketPool::kMaxCachedBlocks;
+
+std::atomic<uint64_t> PacketPool::slab_count_{0};
+
+namespace {
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+class Depot {
+ public:
+  // Moves up to `count` blocks into `out`, allocating a new slab when the depot is empty
+  size_t take(FreeBlock** out, size_t count, std::atomic<uint64_t>* slab_count) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (blocks_.empty()) {
+      char* slab = static_cast<char*>(::operator new(PacketPool::kBlockSize * PacketPool::kBlocksPerSlab));
+      for (size_t index = 0; index < PacketPool::kBlocksPerSlab; index++) {
+        blocks_.push_back(reinterpret_cast<FreeBlock*>(slab + index * PacketPool::kBlockSize));
+      }
+      slab_count->fetch_add(1, std::memory_order_relaxed);
+    }
+    size_t taken = 0;
+    while (taken < count && !blocks_.empty()) {
+      FreeBlock* block = blocks_.back();
+      blocks_.pop_back();
+      block->next = *out;
+      *out = block;
+      taken++;
+    }
+    return taken;
+  }
+
+  void give(FreeBlock* head) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    while (head != nullptr) {
+      FreeBlock* next = head->next;
+      blocks_.push_back(head);
+      head = next;
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<FreeBlock*> blocks_;
+};
+
+Depot& getDepot() {
+  // Leaked on purpose: thread caches may flush into it during static destruction
+  static Depot* depot = new Depot();
+  return *depot;
+}
+
+class ThreadCache {
+ public:
+  ThreadCache() : head_{nullptr}, size_{0} {}
+  ~ThreadCache() {
+    if (head_ != nullptr) {
+      getDepot().give(head_);
+    }
+  }
+
+  FreeBlock* pop(std::atomic<uint64_t>* slab_count) {
+    if (head_ == nullptr) {
+      size_ += getDepot().take(&head_, PacketPool::kBatchSize, slab_count);
+    }
+    FreeBlock* block = head_;
+    head_ = block->next;
+    size_--;
+    return block;
+  }
+
+  void push(FreeBlock* block) {
+    block->next = head_;
+    head_ = block;
+    size_++;
+    if (size_ > PacketPool::kMaxCachedBlocks) {
+      flush(PacketPool::kBatchSize);
+    }
+  }
+
+ private:
+  void flush(size_t count) {
+    FreeBlock* batch = nullptr;
+    for (size_t index = 0; index < count && head_ != nullptr; index++) {
+      FreeBlock* block = head_;
+      head_ = block->next;
+      block->next = batch;
+      batch = block;
+      size_--;
+    }
+    getDepot().give(batch);
+  }
+
+  FreeBlock* head_;
+  size_t size_;
+};
+
+thread_local ThreadCache thread_cache;
+
+}  // namespace
+
+void* PacketPool::allocate() {
+  return thread_cache.pop(&slab_count_);
+}
+
+void PacketPool::deallocate(void* block) {
+  thread_cache.push(static_cast<FreeBlock*>(block));
+}
+
+}  // namespace erizo
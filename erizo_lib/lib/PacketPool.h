@@ -0,0 +1,78 @@
+#ifndef ERIZO_SRC_ERIZO_LIB_PACKETPOOL_H_
+#define ERIZO_SRC_ERIZO_LIB_PACKETPOOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace erizo {
+
+/*
+ * Fixed-size block allocator backing every DataPacket.
+ *
+ * Blocks are carved out of large slabs and recycled through a per-thread cache, so a packet
+ * allocated and released on the same worker never touches a lock or the system allocator.
+ * Threads that only free (or only allocate) exchange blocks with a shared depot in batches of
+ * kBatchSize. Slabs are never returned to the system: the pool grows to the peak number of
+ * packets in flight and stays there.
+ */
+class PacketPool {
+ public:
+  static constexpr size_t kBlockSize = 2048;
+  static constexpr size_t kBlocksPerSlab = 256;
+  static constexpr size_t kBatchSize = 64;
+  static constexpr size_t kMaxCachedBlocks = 4 * kBatchSize;
+
+  static void* allocate();
+  static void deallocate(void* block);
+
+  // Number of slabs requested from the system allocator since startup
+  static uint64_t getSlabCount() { return slab_count_.load(std::memory_order_relaxed); }
+
+ private:
+  static std::atomic<uint64_t> slab_count_;
+};
+
+/*
+ * Standard allocator that serves single objects up to PacketPool::kBlockSize from the pool.
+ * Used through std::allocate_shared so the packet and its reference count share one pooled block.
+ */
+template <typename T>
+class PacketAllocator {
+ public:
+  typedef T value_type;
+
+  PacketAllocator() = default;
+  template <typename U>
+  PacketAllocator(const PacketAllocator<U>&) {}  // NOLINT
+
+  T* allocate(size_t n) {
+    if (n == 1 && sizeof(T) <= PacketPool::kBlockSize) {
+      return static_cast<T*>(PacketPool::allocate());
+    }
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, size_t n) {
+    if (n == 1 && sizeof(T) <= PacketPool::kBlockSize) {
+      PacketPool::deallocate(p);
+      return;
+    }
+    ::operator delete(p);
+  }
+
+  template <typename U>
+  struct rebind {
+    typedef PacketAllocator<U> other;
+  };
+};
+
+template <typename T, typename U>
+inline bool operator==(const PacketAllocator<T>&, const PacketAllocator<U>&) { return true; }
+
+template <typename T, typename U>
+inline bool operator!=(const PacketAllocator<T>&, const PacketAllocator<U>&) { return false; }
+
+}  // namespace erizo
+#endif  // ERIZO_SRC_ERIZO_LIB_PACKETPOOL_H_
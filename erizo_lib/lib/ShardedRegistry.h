@@ -0,0 +1,206 @@
+#ifndef ERIZO_SRC_ERIZO_LIB_SHARDEDREGISTRY_H_
+#define ERIZO_SRC_ERIZO_LIB_SHARDEDREGISTRY_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+namespace erizo {
+
+/*
+ * Map from a non-zero 32 bit handle to a shared_ptr<T>, sharded by the low bits of the handle.
+ * Writers lock their shard, update it and publish an immutable open addressing table. Readers
+ * probe the published table without any lock or reference count, which is only safe from a
+ * fixed set of reader threads that call onQuiescent(reader) whenever they hold no pointer
+ * returned by find(): a replaced table is freed once every reader has been quiescent since it
+ * was retired. A reader that stops must call offline(reader), or it holds back reclamation.
+ * Retired tables keep their objects alive, and a write can only free the tables retired before
+ * it, so reclaim() must also be called periodically, e.g. by a reader after onQuiescent().
+ */
+template <typename T, int kShards>
+class ShardedRegistry {
+  static_assert(kShards > 0 && (kShards & (kShards - 1)) == 0, "kShards must be a power of two");
+
+ public:
+  ShardedRegistry() : epoch_{0}, num_readers_{0} {}
+
+  ~ShardedRegistry() {
+    for (Shard &shard : shards_) {
+      delete shard.table.exchange(nullptr);
+    }
+    for (RetiredTable &retired : retired_) {
+      delete retired.table;
+    }
+  }
+
+  // Only while no reader is running
+  void setReaders(int num_readers) {
+    std::lock_guard<std::mutex> lock(retired_mutex_);
+    reader_epochs_.reset(new ReaderEpoch[num_readers]);
+    for (int i = 0; i < num_readers; i++) {
+      reader_epochs_[i].epoch = epoch_.load();
+    }
+    num_readers_ = num_readers;
+  }
+
+  // Returns false when handle is 0 or already taken by another object
+  bool add(uint32_t handle, std::shared_ptr<T> object) {
+    if (handle == 0) {
+      return false;
+    }
+    Shard &shard = getShard(handle);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.objects.find(handle);
+    if (it != shard.objects.end() && it->second != object) {
+      return false;
+    }
+    shard.objects[handle] = object;
+    publish(&shard);
+    return true;
+  }
+
+  // Only removes the handle while it still maps to object
+  bool remove(uint32_t handle, const std::shared_ptr<T> &object) {
+    Shard &shard = getShard(handle);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.objects.find(handle);
+    if (it == shard.objects.end() || it->second != object) {
+      return false;
+    }
+    shard.objects.erase(it);
+    publish(&shard);
+    return true;
+  }
+
+  std::shared_ptr<T> get(uint32_t handle) {
+    Shard &shard = getShard(handle);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.objects.find(handle);
+    return it != shard.objects.end() ? it->second : nullptr;
+  }
+
+  // Reader threads only, lock free. The pointer stays valid until the reader's next
+  // onQuiescent() or offline().
+  T* find(uint32_t handle) const {
+    const Table *table = getShard(handle).table.load(std::memory_order_acquire);
+    if (table == nullptr) {
+      return nullptr;
+    }
+    size_t mask = table->slots.size() - 1;
+    size_t index = (handle / kShards) & mask;
+    while (table->slots[index].handle != 0) {
+      if (table->slots[index].handle == handle) {
+        return table->slots[index].object.get();
+      }
+      index = (index + 1) & mask;
+    }
+    return nullptr;
+  }
+
+  void onQuiescent(int reader) {
+    reader_epochs_[reader].epoch.store(epoch_.load());
+  }
+
+  // The reader is gone and must not hold back reclamation
+  void offline(int reader) {
+    reader_epochs_[reader].epoch.store(UINT64_MAX);
+  }
+
+  // Frees the retired tables no reader can still be probing
+  void reclaim() {
+    std::lock_guard<std::mutex> lock(retired_mutex_);
+    uint64_t min_epoch = UINT64_MAX;
+    for (int i = 0; i < num_readers_; i++) {
+      min_epoch = std::min(min_epoch, reader_epochs_[i].epoch.load());
+    }
+    auto it = retired_.begin();
+    while (it != retired_.end()) {
+      if (it->epoch <= min_epoch) {
+        delete it->table;
+        it = retired_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  size_t retiredCount() {
+    std::lock_guard<std::mutex> lock(retired_mutex_);
+    return retired_.size();
+  }
+
+ private:
+  // handle 0 marks an empty slot
+  struct Slot {
+    uint32_t handle = 0;
+    std::shared_ptr<T> object;
+  };
+
+  struct Table {
+    std::vector<Slot> slots;
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::map<uint32_t, std::shared_ptr<T>> objects;
+    std::atomic<const Table*> table{nullptr};
+  };
+
+  // Last epoch seen by a reader at a quiescent point, on its own cache line
+  struct ReaderEpoch {
+    std::atomic<uint64_t> epoch;
+    char padding[64 - sizeof(std::atomic<uint64_t>)];
+  };
+
+  struct RetiredTable {
+    const Table *table;
+    uint64_t epoch;
+  };
+
+  Shard& getShard(uint32_t handle) { return shards_[handle & (kShards - 1)]; }
+  const Shard& getShard(uint32_t handle) const { return shards_[handle & (kShards - 1)]; }
+
+  // Called with shard->mutex held
+  void publish(Shard *shard) {
+    // power of two, load factor under 1/2
+    size_t capacity = 8;
+    while (capacity < shard->objects.size() * 2) {
+      capacity *= 2;
+    }
+    Table *table = new Table();
+    table->slots.resize(capacity);
+    size_t mask = capacity - 1;
+    for (auto &entry : shard->objects) {
+      size_t index = (entry.first / kShards) & mask;
+      while (table->slots[index].handle != 0) {
+        index = (index + 1) & mask;
+      }
+      table->slots[index].handle = entry.first;
+      table->slots[index].object = entry.second;
+    }
+
+    const Table *old_table = shard->table.exchange(table);
+    if (old_table != nullptr) {
+      // Readers may still be probing the old table: free it once all of them have gone
+      // through a quiescent point after this epoch
+      std::lock_guard<std::mutex> lock(retired_mutex_);
+      retired_.push_back({old_table, epoch_.fetch_add(1) + 1});
+    }
+    reclaim();
+  }
+
+  Shard shards_[kShards];
+  std::atomic<uint64_t> epoch_;
+  std::unique_ptr<ReaderEpoch[]> reader_epochs_;
+  int num_readers_;
+  std::vector<RetiredTable> retired_;
+  std::mutex retired_mutex_;
+};
+
+}  // namespace erizo
+#endif  // ERIZO_SRC_ERIZO_LIB_SHARDEDREGISTRY_H_
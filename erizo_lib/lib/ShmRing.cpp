@@ -0,0 +1,122 @@
+#include "lib/ShmRing.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace erizo {
+
+constexpr size_t kHeaderSize = 64;
+constexpr size_t kSlotAlignment = 64;
+
+struct ShmRing::Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t slot_size;
+  std::atomic<uint64_t> head;
+};
+
+struct ShmRing::Slot {
+  std::atomic<uint64_t> sequence;
+  uint32_t length;
+  uint16_t part;
+  uint16_t parts;
+  char data[1];
+};
+
+ShmRing::ShmRing() : memory_{nullptr}, size_{0}, slot_count_{0}, slot_size_{0}, slot_stride_{0} {
+}
+
+ShmRing::~ShmRing() {
+  close();
+}
+
+int ShmRing::open(const std::string &name, uint32_t slot_count, uint32_t slot_size) {
+  static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "shared atomics must be plain words");
+  static_assert(offsetof(Slot, data) == 16, "slot payload must start at byte 16");
+  close();
+  // parts are numbered in 16 bits
+  if (name.empty() || slot_count == 0 || slot_count > UINT16_MAX || slot_size == 0) {
+    return 1;
+  }
+  size_t stride = (offsetof(Slot, data) + slot_size + kSlotAlignment - 1) / kSlotAlignment * kSlotAlignment;
+  size_t size = kHeaderSize + stride * slot_count;
+
+  int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+  if (fd < 0) {
+    return 1;
+  }
+  if (ftruncate(fd, size) != 0) {
+    ::close(fd);
+    return 1;
+  }
+  void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (memory == MAP_FAILED) {
+    return 1;
+  }
+
+  name_ = name;
+  memory_ = reinterpret_cast<char*>(memory);
+  size_ = size;
+  slot_count_ = slot_count;
+  slot_size_ = slot_size;
+  slot_stride_ = stride;
+
+  // A leftover object from a previous run may have another geometry, start from scratch
+  memset(memory_, 0, size_);
+  Header *header = reinterpret_cast<Header*>(memory_);
+  header->magic = kMagic;
+  header->version = kVersion;
+  header->slot_count = slot_count_;
+  header->slot_size = slot_size_;
+  header->head.store(0, std::memory_order_release);
+  return 0;
+}
+
+void ShmRing::close() {
+  if (!memory_) {
+    return;
+  }
+  munmap(memory_, size_);
+  shm_unlink(name_.c_str());
+  memory_ = nullptr;
+  size_ = 0;
+  slot_count_ = 0;
+  slot_size_ = 0;
+  name_.clear();
+}
+
+ShmRing::Slot* ShmRing::slotAt(uint64_t record) {
+  return reinterpret_cast<Slot*>(memory_ + kHeaderSize + (record % slot_count_) * slot_stride_);
+}
+
+bool ShmRing::write(const char *data, uint32_t length) {
+  if (!memory_ || length > capacity()) {
+    return false;
+  }
+  // An empty message still takes one record
+  uint32_t parts = length == 0 ? 1 : (length + slot_size_ - 1) / slot_size_;
+  Header *header = reinterpret_cast<Header*>(memory_);
+  uint64_t record = header->head.load(std::memory_order_relaxed);
+
+  for (uint32_t part = 0; part < parts; part++, record++) {
+    uint32_t part_length = std::min(slot_size_, length - part * slot_size_);
+    Slot *slot = slotAt(record);
+    slot->sequence.store(2 * record + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->length = part_length;
+    slot->part = static_cast<uint16_t>(part);
+    slot->parts = static_cast<uint16_t>(parts);
+    memcpy(slot->data, data + part * slot_size_, part_length);
+    slot->sequence.store(2 * record + 2, std::memory_order_release);
+    header->head.store(record + 1, std::memory_order_release);
+  }
+  return true;
+}
+
+}  // namespace erizo
@@ -0,0 +1,64 @@
+#ifndef ERIZO_SRC_ERIZO_LIB_SHMRING_H_
+#define ERIZO_SRC_ERIZO_LIB_SHMRING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace erizo {
+
+/*
+ * Single-writer ring of records in a POSIX shared memory object, for a process on the same host
+ * to read without any call into the writer. Readers never block the writer: each slot is guarded
+ * by a sequence number (odd while being written), so a reader copies a slot and keeps the copy
+ * only if the sequence is even and unchanged afterwards. A message longer than a slot is split
+ * into parts written to consecutive records.
+ *
+ * Layout, little endian, all offsets from the start of the object:
+ *   0   uint32 magic ("ERSR")     4  uint32 version (2)
+ *   8   uint32 slot count        12  uint32 slot size, payload bytes per slot
+ *   16  uint64 head, number of records written so far
+ *   64  slot[0], then every slot at 64 + index * (16 + slot size rounded up to 64)
+ * A slot is uint64 sequence (2 * record + 1 while writing, 2 * record + 2 once written),
+ * uint32 length, uint16 part, uint16 parts, then the payload. Record n is in slot n % slot count.
+ * A message is the payloads of its parts 0 to parts - 1, in consecutive records. A reader skips
+ * parts until one numbered 0, and drops a message when any of its parts was overwritten.
+ */
+class ShmRing {
+ public:
+  static constexpr uint32_t kMagic = 0x52535245;  // "ERSR"
+  static constexpr uint32_t kVersion = 2;
+
+  ShmRing();
+  ~ShmRing();
+
+  // Creates, or reuses and resets, the shared memory object called name
+  int open(const std::string &name, uint32_t slot_count, uint32_t slot_size);
+  void close();
+  bool isOpen() const { return memory_ != nullptr; }
+
+  // Returns false, writing nothing, when the message would take more than every slot or the
+  // ring is not open
+  bool write(const char *data, uint32_t length);
+
+  // Largest message write() takes, 0 when not open
+  size_t capacity() const { return static_cast<size_t>(slot_count_) * slot_size_; }
+
+ private:
+  struct Header;
+  struct Slot;
+
+  Slot* slotAt(uint64_t record);
+
+  std::string name_;
+  char *memory_;
+  size_t size_;
+  uint32_t slot_count_;
+  uint32_t slot_size_;
+  size_t slot_stride_;
+};
+
+}  // namespace erizo
+
+#endif  // ERIZO_SRC_ERIZO_LIB_SHMRING_H_
@@ -0,0 +1,109 @@
+#include "lib/TimerWheel.h"
+
+#include <utility>
+
+namespace erizo {
+
+TimerWheel::TimerWheel(time_point start, duration tick)
+    : start_{start}, tick_{tick}, current_tick_{0}, size_{0} {
+}
+
+uint64_t TimerWheel::ticksAt(time_point when) const {
+  if (when <= start_) {
+    return 0;
+  }
+  // Rounded up, so that a timer never fires early
+  return (when - start_ + tick_ - duration{1}) / tick_;
+}
+
+void TimerWheel::add(time_point when, Callback callback) {
+  uint64_t expiry = ticksAt(when);
+  if (expiry <= current_tick_) {
+    expiry = current_tick_ + 1;
+  }
+  place(Timer{expiry, std::move(callback)});
+  size_++;
+}
+
+void TimerWheel::place(Timer timer) {
+  uint64_t delta = timer.expiry - current_tick_;
+  int level = 0;
+  while (level < kLevels - 1 && delta >= (uint64_t{1} << ((level + 1) * kSlotBits))) {
+    level++;
+  }
+  uint64_t slot;
+  if (level == kLevels - 1 && delta >= (uint64_t{1} << (kLevels * kSlotBits))) {
+    // Beyond the wheel: park it in the farthest slot, it is placed again when it cascades
+    slot = ((current_tick_ >> (level * kSlotBits)) - 1) & kSlotMask;
+  } else {
+    slot = (timer.expiry >> (level * kSlotBits)) & kSlotMask;
+  }
+  slots_[level][slot].push_back(std::move(timer));
+}
+
+void TimerWheel::cascade(int level) {
+  uint64_t slot = (current_tick_ >> (level * kSlotBits)) & kSlotMask;
+  std::vector<Timer> timers;
+  timers.swap(slots_[level][slot]);
+  for (Timer &timer : timers) {
+    place(std::move(timer));
+  }
+}
+
+size_t TimerWheel::step() {
+  current_tick_++;
+  // Bring the timers of the upper slots that start now down before running this tick
+  for (int level = 1; level < kLevels; level++) {
+    if ((current_tick_ & ((uint64_t{1} << (level * kSlotBits)) - 1)) != 0) {
+      break;
+    }
+    cascade(level);
+  }
+  std::vector<Timer> due;
+  due.swap(slots_[0][current_tick_ & kSlotMask]);
+  size_ -= due.size();
+  for (Timer &timer : due) {
+    timer.callback();
+  }
+  return due.size();
+}
+
+size_t TimerWheel::advance(time_point now) {
+  uint64_t target = now <= start_ ? 0 : (now - start_) / tick_;
+  size_t ran = 0;
+  while (current_tick_ < target) {
+    if (size_ == 0) {
+      current_tick_ = target;
+      break;
+    }
+    ran += step();
+  }
+  return ran;
+}
+
+time_point TimerWheel::nextExpiry() const {
+  if (size_ == 0) {
+    return time_point::max();
+  }
+  for (uint64_t tick = current_tick_ + 1; tick <= current_tick_ + kSlots; tick++) {
+    if ((tick & kSlotMask) == 0) {
+      // Level 0 is empty up to here, upper levels cascade at this tick
+      return start_ + tick_ * tick;
+    }
+    if (!slots_[0][tick & kSlotMask].empty()) {
+      return start_ + tick_ * tick;
+    }
+  }
+  return start_ + tick_ * (current_tick_ + kSlots);
+}
+
+void TimerWheel::clear() {
+  for (auto &level : slots_) {
+    for (auto &slot : level) {
+      slot.clear();
+    }
+  }
+  size_ = 0;
+}
+
+}  // namespace erizo
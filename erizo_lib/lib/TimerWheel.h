@@ -0,0 +1,63 @@
+#ifndef ERIZO_SRC_ERIZO_LIB_TIMERWHEEL_H_
+#define ERIZO_SRC_ERIZO_LIB_TIMERWHEEL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "lib/Clock.h"
+
+namespace erizo {
+
+/*
+ * Hierarchical timer wheel: four levels of 256 slots, the first one tick per slot, each next
+ * one 256 times coarser. Adding a timer is O(1), and so is each tick, apart from the timers
+ * cascading down a level every 256 ticks of the level above. Timers never fire early; they
+ * fire up to one tick late. Cancelling is left to the callbacks, which can check a flag.
+ * Not thread safe: a Worker owns one and only touches it from its own thread.
+ */
+class TimerWheel {
+ public:
+  typedef std::function<void()> Callback;
+
+  explicit TimerWheel(time_point start, duration tick = std::chrono::milliseconds(1));
+
+  void add(time_point when, Callback callback);
+
+  // Runs every timer due by now, returns how many ran
+  size_t advance(time_point now);
+
+  // When the next timers are due, or time_point::max() when there are none. It can be a
+  // cascade point when the nearest timers are still on an upper level.
+  time_point nextExpiry() const;
+
+  size_t size() const { return size_; }
+  void clear();
+
+ private:
+  static constexpr int kLevels = 4;
+  static constexpr int kSlotBits = 8;
+  static constexpr uint64_t kSlots = 1 << kSlotBits;
+  static constexpr uint64_t kSlotMask = kSlots - 1;
+
+  struct Timer {
+    uint64_t expiry;
+    Callback callback;
+  };
+
+  uint64_t ticksAt(time_point when) const;
+  void place(Timer timer);
+  void cascade(int level);
+  size_t step();
+
+  time_point start_;
+  duration tick_;
+  uint64_t current_tick_;
+  size_t size_;
+  std::vector<Timer> slots_[kLevels][kSlots];
+};
+
+}  // namespace erizo
+
+#endif  // ERIZO_SRC_ERIZO_LIB_TIMERWHEEL_H_
@@ -132,6 +132,36 @@ bool H264Depacketizer::isKeyframe() const {
 void H264Depacketizer::resetImpl() {
   last_payload_ = nullptr;
   search_state_ = SearchState::lookingForStart;
+  frame_.nal_units.clear();
+}
+
+// Called with the buffer pointer on the start sequence of a new NAL unit
+void H264Depacketizer::startNalUnit(uint8_t type) {
+  H264NalUnit nal_unit;
+  nal_unit.offset = getBufferPtr() - buffer();
+  nal_unit.size = 0;
+  nal_unit.type = type & 0x1f;
+  frame_.nal_units.push_back(nal_unit);
+}
+
+void H264Depacketizer::finishFrame() {
+  frame_.data = frame();
+  frame_.size = frameSize();
+  frame_.keyframe = false;
+  frame_.sps_index = -1;
+  frame_.pps_index = -1;
+  for (size_t index = 0; index < frame_.nal_units.size(); index++) {
+    H264NalUnit& nal_unit = frame_.nal_units[index];
+    int end = index + 1 < frame_.nal_units.size() ? frame_.nal_units[index + 1].offset : frame_.size;
+    nal_unit.size = end - nal_unit.offset;
+    if (nal_unit.type == 5) {
+      frame_.keyframe = true;
+    } else if (nal_unit.type == 7) {
+      frame_.sps_index = index;
+    } else if (nal_unit.type == 8) {
+      frame_.pps_index = index;
+    }
+  }
 }
 
 bool H264Depacketizer::processPacket() {
@@ -145,10 +175,12 @@ bool H264Depacketizer::processPacket() {
       }
       const auto total_size = last_payload_->dataLength + sizeof(RTPPayloadH264::start_sequence);
       if (bufferCheck(total_size)) {
+        startNalUnit(last_payload_->data[0]);
         std::memcpy(getBufferPtr(), RTPPayloadH264::start_sequence, sizeof(RTPPayloadH264::start_sequence));
         setBufferPtr(getBufferPtr() + sizeof(RTPPayloadH264::start_sequence));
         std::memcpy(getBufferPtr(), last_payload_->data, last_payload_->dataLength);
         setBufferPtr(getBufferPtr() + last_payload_->dataLength);
+        finishFrame();
         return true;
       }
       break;
@@ -166,6 +198,7 @@ bool H264Depacketizer::processPacket() {
             reset();
           }
           search_state_ = SearchState::lookingForEnd;
+          startNalUnit(last_payload_->fragment_nal_header);
           std::memcpy(getBufferPtr(), RTPPayloadH264::start_sequence, sizeof(RTPPayloadH264::start_sequence));
           setBufferPtr(getBufferPtr() + sizeof(RTPPayloadH264::start_sequence));
           std::memcpy(getBufferPtr(), &last_payload_->fragment_nal_header, last_payload_->fragment_nal_header_len);
@@ -175,6 +208,7 @@ bool H264Depacketizer::processPacket() {
         setBufferPtr(getBufferPtr() + last_payload_->dataLength);
         if (last_payload_->end_bit) {
           search_state_ = SearchState::lookingForStart;
+          finishFrame();
           return true;
         }
       }
@@ -185,8 +219,19 @@ bool H264Depacketizer::processPacket() {
         return false;
       }
       if (bufferCheck(last_payload_->unpacked_data_len)) {
+        // the parser already split the aggregate, each unit is a start sequence and nal_size bytes
+        const unsigned char* nal_unit = &last_payload_->unpacked_data[0];
+        for (unsigned nal_size : last_payload_->unpacked_nal_sizes) {
+          H264NalUnit annotation;
+          annotation.offset = (getBufferPtr() - buffer()) + (nal_unit - &last_payload_->unpacked_data[0]);
+          annotation.size = 0;
+          annotation.type = nal_size > 0 ? nal_unit[sizeof(RTPPayloadH264::start_sequence)] & 0x1f : 0;
+          frame_.nal_units.push_back(annotation);
+          nal_unit += sizeof(RTPPayloadH264::start_sequence) + nal_size;
+        }
         std::memcpy(getBufferPtr(), &last_payload_->unpacked_data[0], last_payload_->unpacked_data_len);
         setBufferPtr(getBufferPtr() + last_payload_->unpacked_data_len);
+        finishFrame();
         return true;
       }
     }
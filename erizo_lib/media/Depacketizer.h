@@ -8,9 +8,43 @@
 #include <memory>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 namespace erizo {
 
+/**
+ * One Annex B NAL unit of a depacketized H.264 frame. offset and size include the start sequence.
+ */
+struct H264NalUnit {
+  int offset;
+  int size;
+  uint8_t type;
+};
+
+/**
+ * A depacketized H.264 frame, annotated while it was assembled so that consumers never
+ * search it for start codes. It points into the depacketizer buffer and stays valid until
+ * the depacketizer is reset or fed again.
+ */
+struct H264Frame {
+  const unsigned char* data = nullptr;
+  int size = 0;
+  std::vector<H264NalUnit> nal_units;
+  // an IDR slice is present
+  bool keyframe = false;
+  // indexes in nal_units of the last SPS and PPS, -1 when absent
+  int sps_index = -1;
+  int pps_index = -1;
+
+  const H264NalUnit* sps() const {
+    return sps_index < 0 ? nullptr : &nal_units[sps_index];
+  }
+
+  const H264NalUnit* pps() const {
+    return pps_index < 0 ? nullptr : &nal_units[pps_index];
+  }
+};
+
 /**
  * Decomposes rtp packets into frames
  */
@@ -108,11 +142,22 @@ class H264Depacketizer: public Depacketizer {
   bool processPacket() override;
 
   bool isKeyframe() const override;
+
+  /**
+   * @returns The NAL units of the frame returned by the last successful processPacket
+   */
+  const H264Frame& annotatedFrame() const {
+    return frame_;
+  }
+
  private:
   void resetImpl() override;
+  void startNalUnit(uint8_t type);
+  void finishFrame();
 
   RtpH264Parser parser_;
   std::unique_ptr<erizo::RTPPayloadH264> last_payload_;
+  H264Frame frame_;
 };
 }  // namespace erizo
 
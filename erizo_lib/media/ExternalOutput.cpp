@@ -595,86 +595,11 @@ void ExternalOutput::updateVideoCodec(RtpMap map)
     }
     else if (map.encoding_name == "H264")
     {
-        depacketizer_.reset(new H264Depacketizer());
+        h264_depacketizer_ = new H264Depacketizer();
+        depacketizer_.reset(h264_depacketizer_);
     }
 }
 
-bool ExternalOutput::findSps(uint8_t *buf, int len, uint8_t *sps, int &len_sps)
-{
-    bool find_header = false;
-    int i = 0;
-    int header_pos = 0;
-    while (!find_header && i < len - 5)
-    {
-        if (buf[i] == 0 && buf[i + 1] == 0 && buf[i + 2] == 0 && buf[i + 3] == 1 && buf[i + 4] == 0x67)
-        {
-            find_header = true;
-            header_pos = i;
-            break;
-        }
-        i++;
-    }
-
-    if (!find_header)
-    {
-        return false;
-    }
-    i = header_pos + 5;
-    int tail_pos = len - 1;
-    bool find_tail = false;
-    while (!find_tail && i < len - 5)
-    {
-        if (buf[i] == 0 && buf[i + 1] == 0 && buf[i + 2] == 0 && buf[i + 3] == 1)
-        {
-            tail_pos = i - 1;
-            break;
-        }
-        i++;
-    }
-
-    memcpy(sps, buf + header_pos, tail_pos - header_pos + 1);
-    len_sps = tail_pos - header_pos + 1;
-    return true;
-}
-
-bool ExternalOutput::findPps(uint8_t *buf, int len, uint8_t *pps, int &pps_len)
-{
-    bool find_header = false;
-    int i = 0;
-    int header_pos = 0;
-    while (!find_header && i < len - 5)
-    {
-        if (buf[i] == 0 && buf[i + 1] == 0 && buf[i + 2] == 0 && buf[i + 3] == 1 && buf[i + 4] == 0x68)
-        {
-            find_header = true;
-            header_pos = i;
-            break;
-        }
-        i++;
-    }
-
-    if (!find_header)
-    {
-        return false;
-    }
-    i = header_pos + 5;
-    int tail_pos = len - 1;
-    bool find_tail = false;
-    while (!find_tail && i < len - 5)
-    {
-        if (buf[i] == 0 && buf[i + 1] == 0 && buf[i + 2] == 0 && buf[i + 3] == 1)
-        {
-            tail_pos = i - 1;
-            break;
-        }
-        i++;
-    }
-
-    memcpy(pps, buf + header_pos, tail_pos - header_pos + 1);
-    pps_len = tail_pos - header_pos + 1;
-    return true;
-}
-
 void ExternalOutput::maybeWriteVideoPacket(char *buf, int len)
 {
     RtpHeader *head = reinterpret_cast<RtpHeader *>(buf);
@@ -704,26 +629,27 @@ void ExternalOutput::maybeWriteVideoPacket(char *buf, int len)
         }
         timestamp_to_write = (current_timestamp - first_video_timestamp_) * 1000 / video_iterator->second.clock_rate;
 
-        AVPacket av_packet;
-        av_init_packet(&av_packet);
-        unsigned char *data = depacketizer_->frame();
-        int size = depacketizer_->frameSize();
+        if (!h264_depacketizer_)
+        {
+            depacketizer_->reset();
+            return;
+        }
+        //解包时已标注好nalu，所有recorder共用这一帧，不再查找sps/pps
+        const H264Frame &frame = h264_depacketizer_->annotatedFrame();
         //添加h264 track
         if (!got_sps_pps_)
         {
-            uint8_t sps[128];
-            int sps_len = 0;
-            uint8_t pps[128];
-            int pps_len = 0;
-            if (findSps(data, size, sps, sps_len) && findPps(data, size, pps, pps_len))
+            const H264NalUnit *sps = frame.sps();
+            const H264NalUnit *pps = frame.pps();
+            if (sps && pps)
             { //找到sps了
                 for (auto r : recorders_)
                 {
                     if (r)
                     {
-                        r->SetSPS(sps, sps_len);
-                        r->SetPPS(pps, pps_len);
-                        r->WriteH264Data(data, size, timestamp_to_write);
+                        r->SetSPS(frame.data + sps->offset, sps->size);
+                        r->SetPPS(frame.data + pps->offset, pps->size);
+                        r->WriteH264Frame(frame, timestamp_to_write);
                     }
                 }
                 got_sps_pps_ = true;
@@ -735,7 +661,7 @@ void ExternalOutput::maybeWriteVideoPacket(char *buf, int len)
             {
                 if (r)
                 {
-                    r->WriteH264Data(data, size, timestamp_to_write);
+                    r->WriteH264Frame(frame, timestamp_to_write);
                 }
             }
         }
@@ -787,7 +713,7 @@ void ExternalOutput::queueDataAsync(std::shared_ptr<DataPacket> copied_packet)
 int ExternalOutput::deliverAudioData_(std::shared_ptr<DataPacket> audio_packet, const std::string &stream_id)
 {
     last_packet_time_ = time(NULL);
-    std::shared_ptr<DataPacket> copied_packet = std::make_shared<DataPacket>(*audio_packet);
+    std::shared_ptr<DataPacket> copied_packet = makeDataPacket(*audio_packet);
     copied_packet->type = AUDIO_PACKET;
     queueDataAsync(copied_packet);
     return 0;
@@ -802,7 +728,7 @@ int ExternalOutput::deliverVideoData_(std::shared_ptr<DataPacket> video_packet,
         video_source_ssrc_ = h->getSSRC();
     }
 
-    std::shared_ptr<DataPacket> copied_packet = std::make_shared<DataPacket>(*video_packet);
+    std::shared_ptr<DataPacket> copied_packet = makeDataPacket(*video_packet);
     copied_packet->type = VIDEO_PACKET;
     ext_processor_.processRtpExtensions(copied_packet);
     queueDataAsync(copied_packet);
@@ -933,7 +859,7 @@ int ExternalOutput::sendFirPacket()
         pli_header.setLength(2);
         char *buf = reinterpret_cast<char *>(&pli_header);
         int len = (pli_header.getLength() + 1) * 4;
-        std::shared_ptr<DataPacket> pli_packet = std::make_shared<DataPacket>(0, buf, len, VIDEO_PACKET);
+        std::shared_ptr<DataPacket> pli_packet = makeDataPacket(0, buf, len, VIDEO_PACKET);
         fb_sink_->deliverFeedback(pli_packet);
         return len;
     }
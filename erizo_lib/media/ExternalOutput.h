@@ -98,6 +98,8 @@ class ExternalOutput : public MediaSink, public RawDataReceiver, public Feedback
   std::condition_variable cond_;
   uint32_t video_source_ssrc_;
   std::unique_ptr<Depacketizer> depacketizer_ = nullptr;
+  // depacketizer_ when the video is H.264, its frames come annotated with their NAL units
+  H264Depacketizer* h264_depacketizer_ = nullptr;
 
   // Timestamping strategy: we use the RTP timestamps so we don't have to restamp and we're not
   // subject to error due to the RTP packet queue depth and playout.
@@ -178,8 +180,6 @@ class ExternalOutput : public MediaSink, public RawDataReceiver, public Feedback
   void initializePipeline();
   void syncClose();
 
-  bool findSps(uint8_t* buf, int len, uint8_t* sps, int &sps_len);
-  bool findPps(uint8_t* buf, int len, uint8_t* pps, int &pps_len);
   void write_audio_metadata(uint8_t *buf, int samplerate, int channels);
   int initAudioCodec(int sample_rate, int channel_num);
   bool reEncodeAudioData(uint8_t *buf, size_t len, int sample_rate, int channels, uint8_t *out_buf, size_t &out_len);
@@ -72,7 +72,7 @@ int InputProcessor::init(const MediaInfo& info, RawDataReceiver* receiver) {
 
 int InputProcessor::deliverAudioData_(std::shared_ptr<DataPacket> audio_packet, const std::string &stream_id) {
   if (audioDecoder && audioUnpackager) {
-    std::shared_ptr<DataPacket> copied_packet = std::make_shared<DataPacket>(*audio_packet);
+    std::shared_ptr<DataPacket> copied_packet = makeDataPacket(*audio_packet);
     ELOG_DEBUG("Decoding audio");
     int unp = unpackageAudio((unsigned char*) copied_packet->data, copied_packet->length,
         unpackagedAudioBuffer_);
@@ -89,7 +89,7 @@ int InputProcessor::deliverAudioData_(std::shared_ptr<DataPacket> audio_packet,
 }
 int InputProcessor::deliverVideoData_(std::shared_ptr<DataPacket> video_packet, const std::string &stream_id) {
   if (videoUnpackager && videoDecoder) {
-    std::shared_ptr<DataPacket> copied_packet = std::make_shared<DataPacket>(*video_packet);
+    std::shared_ptr<DataPacket> copied_packet = makeDataPacket(*video_packet);
     int ret = unpackageVideo(reinterpret_cast<unsigned char*>(copied_packet->data), copied_packet->length,
         unpackagedBufferPtr_, &gotUnpackagedFrame_);
     if (ret < 0)
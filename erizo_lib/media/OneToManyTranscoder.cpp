@@ -94,7 +94,7 @@ void OneToManyTranscoder::receiveRtpData(unsigned char*rtpdata, int len) {
   if (subscribers.empty() || len <= 0)
   return;
   std::map<std::string, MediaSink*>::iterator it;
-  std::shared_ptr<DataPacket> data_packet = std::make_shared<DataPacket>(0,
+  std::shared_ptr<DataPacket> data_packet = makeDataPacket(0,
       reinterpret_cast<char*>(rtpdata), len, VIDEO_PACKET);
   for (it = subscribers.begin(); it != subscribers.end(); it++) {
     (*it).second->deliverVideoData(data_packet);
@@ -136,7 +136,7 @@ void SyntheticInput::sendVideoframe(bool is_keyframe, bool is_marker, uint32_t s
     keyframe_requested_ = false;
   }
   if (video_sink_) {
-    video_sink_->deliverVideoData(std::make_shared<DataPacket>(0, packet_buffer, size, VIDEO_PACKET));
+    video_sink_->deliverVideoData(makeDataPacket(0, packet_buffer, size, VIDEO_PACKET));
   }
   delete header;
 }
@@ -152,7 +152,7 @@ void SyntheticInput::sendAudioFrame(uint32_t size) {
   memset(packet_buffer, 0, size);
   memcpy(packet_buffer, reinterpret_cast<char*>(header), header->getHeaderLength());
   if (audio_sink_) {
-    audio_sink_->deliverAudioData(std::make_shared<DataPacket>(0, packet_buffer, size, AUDIO_PACKET));
+    audio_sink_->deliverAudioData(makeDataPacket(0, packet_buffer, size, AUDIO_PACKET));
   }
   delete header;
 }
@@ -0,0 +1,99 @@
+#include "media/mixers/I420Compositor.h"
+
+#include <algorithm>
+
+#include "third_party/libyuv/include/libyuv/planar_functions.h"
+#include "third_party/libyuv/include/libyuv/scale.h"
+
+namespace erizo
+{
+
+I420Planes I420Planes::fromBuffer(const webrtc::I420BufferInterface &buffer)
+{
+    I420Planes planes;
+    planes.y = buffer.DataY();
+    planes.u = buffer.DataU();
+    planes.v = buffer.DataV();
+    planes.stride_y = buffer.StrideY();
+    planes.stride_u = buffer.StrideU();
+    planes.stride_v = buffer.StrideV();
+    planes.width = buffer.width();
+    planes.height = buffer.height();
+    return planes;
+}
+
+void I420Compositor::clear(webrtc::I420Buffer *canvas)
+{
+    webrtc::I420Buffer::SetBlack(canvas);
+}
+
+static void blendPlane(const uint8_t *src, int src_stride,
+                       uint8_t *dst, int dst_stride,
+                       int width, int height, int alpha)
+{
+    if(alpha >= 255) {
+        libyuv::CopyPlane(src, src_stride, dst, dst_stride, width, height);
+    } else {
+        // dst = dst * (256 - alpha) / 256 + src * alpha / 256, done in place
+        libyuv::InterpolatePlane(dst, dst_stride, src, src_stride, dst, dst_stride, width, height, alpha);
+    }
+}
+
+void I420Compositor::scaleLayer(const I420Planes &src, int width, int height,
+                                rtc::scoped_refptr<webrtc::I420Buffer> *scaled)
+{
+    width &= ~1;
+    height &= ~1;
+    if(width <= 0 || height <= 0 || !src.y || src.width <= 0 || src.height <= 0) {
+        *scaled = nullptr;
+        return;
+    }
+    if(!*scaled || (*scaled)->width() != width || (*scaled)->height() != height) {
+        *scaled = webrtc::I420Buffer::Create(width, height);
+    }
+    webrtc::I420Buffer *dst = scaled->get();
+    libyuv::I420Scale(src.y, src.stride_y, src.u, src.stride_u, src.v, src.stride_v,
+                      src.width, src.height,
+                      dst->MutableDataY(), dst->StrideY(),
+                      dst->MutableDataU(), dst->StrideU(),
+                      dst->MutableDataV(), dst->StrideV(),
+                      width, height, libyuv::kFilterBox);
+}
+
+void I420Compositor::blitLayer(const webrtc::I420BufferInterface &scaled,
+                               int x, int y, int alpha,
+                               webrtc::I420Buffer *canvas)
+{
+    x &= ~1;
+    y &= ~1;
+    alpha = std::min(alpha, 255);
+    if(alpha <= 0) {
+        return;
+    }
+
+    int left = std::max(x, 0);
+    int top = std::max(y, 0);
+    int right = std::min(x + scaled.width(), canvas->width());
+    int bottom = std::min(y + scaled.height(), canvas->height());
+    if(right <= left || bottom <= top) {
+        return;
+    }
+
+    int src_x = left - x;
+    int src_y = top - y;
+    int visible_width = right - left;
+    int visible_height = bottom - top;
+    int uv_width = (visible_width + 1) / 2;
+    int uv_height = (visible_height + 1) / 2;
+    blendPlane(scaled.DataY() + src_y * scaled.StrideY() + src_x, scaled.StrideY(),
+               canvas->MutableDataY() + top * canvas->StrideY() + left, canvas->StrideY(),
+               visible_width, visible_height, alpha);
+    blendPlane(scaled.DataU() + (src_y / 2) * scaled.StrideU() + src_x / 2, scaled.StrideU(),
+               canvas->MutableDataU() + (top / 2) * canvas->StrideU() + left / 2, canvas->StrideU(),
+               uv_width, uv_height, alpha);
+    blendPlane(scaled.DataV() + (src_y / 2) * scaled.StrideV() + src_x / 2, scaled.StrideV(),
+               canvas->MutableDataV() + (top / 2) * canvas->StrideV() + left / 2, canvas->StrideV(),
+               uv_width, uv_height, alpha);
+}
+
+} // namespace erizo
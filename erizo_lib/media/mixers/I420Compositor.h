@@ -0,0 +1,54 @@
+/*
+* I420Compositor.h
+*/
+#ifndef ERIZO_SRC_ERIZO_MEDIA_MIXERS_I420COMPOSITOR_H_
+#define ERIZO_SRC_ERIZO_MEDIA_MIXERS_I420COMPOSITOR_H_
+
+#include <cstdint>
+
+#include "api/scoped_refptr.h"
+#include "api/video/i420_buffer.h"
+
+namespace erizo
+{
+
+// Read-only view of the three planes of an I420 image
+struct I420Planes
+{
+    const uint8_t *y = nullptr;
+    const uint8_t *u = nullptr;
+    const uint8_t *v = nullptr;
+    int stride_y = 0;
+    int stride_u = 0;
+    int stride_v = 0;
+    int width = 0;
+    int height = 0;
+
+    static I420Planes fromBuffer(const webrtc::I420BufferInterface &buffer);
+};
+
+/*
+ * Composites I420 layers into an I420 canvas without leaving planar YUV. Each layer is scaled
+ * once by libyuv, then copied or blended into its canvas region. Layers are painted in call
+ * order, so the caller decides the z-order; alpha (0-255) blends a layer over what is already
+ * painted. Offsets and sizes are aligned down to even values, chroma being subsampled 2x2.
+ */
+class I420Compositor
+{
+public:
+    // Paints the whole canvas black
+    static void clear(webrtc::I420Buffer *canvas);
+
+    // Scales src to width x height into *scaled, which is (re)allocated when its size differs
+    static void scaleLayer(const I420Planes &src, int width, int height,
+                           rtc::scoped_refptr<webrtc::I420Buffer> *scaled);
+
+    // Copies, or blends when alpha is below 255, a scaled layer into canvas at (x, y), clipped
+    // to the canvas
+    static void blitLayer(const webrtc::I420BufferInterface &scaled,
+                          int x, int y, int alpha,
+                          webrtc::I420Buffer *canvas);
+};
+
+} // namespace erizo
+#endif // ERIZO_SRC_ERIZO_MEDIA_MIXERS_I420COMPOSITOR_H_
@@ -0,0 +1,89 @@
+#include "media/mixers/MixerThreadPool.h"
+
+#include <string>
+
+namespace erizo
+{
+
+DEFINE_LOGGER(MixerThreadPool, "MixerThreadPool");
+
+constexpr unsigned int MixerThreadPool::kDefaultThreadNum;
+
+MixerThreadPool *MixerThreadPool::getInstance()
+{
+    static MixerThreadPool instance;
+    return &instance;
+}
+
+MixerThreadPool::MixerThreadPool()
+{
+}
+
+MixerThreadPool::~MixerThreadPool()
+{
+    close();
+}
+
+void MixerThreadPool::start(unsigned int num_threads)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(!threads_.empty()) {
+        return;
+    }
+    startThreads(num_threads);
+}
+
+void MixerThreadPool::startThreads(unsigned int num_threads)
+{
+    for(unsigned int index = 0; index < num_threads; index++) {
+        PooledThread pooled;
+        pooled.thread = rtc::Thread::Create();
+        pooled.thread->SetName("mixer_worker_" + std::to_string(index), nullptr);
+        pooled.thread->Start();
+        threads_.push_back(std::move(pooled));
+    }
+}
+
+void MixerThreadPool::close()
+{
+    std::vector<PooledThread> threads;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        threads.swap(threads_);
+    }
+    for(auto &pooled : threads) {
+        if(pooled.users > 0) {
+            ELOG_WARN("mixer worker %s stopped with %d users", pooled.thread->name().c_str(), pooled.users);
+        }
+        pooled.thread->Stop();
+    }
+}
+
+rtc::Thread *MixerThreadPool::acquire()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(threads_.empty()) {
+        startThreads(kDefaultThreadNum);
+    }
+    PooledThread *least_used = &threads_[0];
+    for(auto &pooled : threads_) {
+        if(pooled.users < least_used->users) {
+            least_used = &pooled;
+        }
+    }
+    least_used->users++;
+    return least_used->thread.get();
+}
+
+void MixerThreadPool::release(rtc::Thread *thread)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(auto &pooled : threads_) {
+        if(pooled.thread.get() == thread) {
+            pooled.users--;
+            return;
+        }
+    }
+}
+
+} // namespace erizo
@@ -0,0 +1,55 @@
+/*
+* MixerThreadPool.h
+*/
+#ifndef ERIZO_SRC_ERIZO_MEDIA_MIXERS_MIXERTHREADPOOL_H_
+#define ERIZO_SRC_ERIZO_MEDIA_MIXERS_MIXERTHREADPOOL_H_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "rtc_base/thread.h"
+#include "./logger.h"
+
+namespace erizo
+{
+
+/*
+ * webrtc worker threads shared by every StreamMixer. A mixer runs its send and receive Calls
+ * on threads taken from here instead of starting two rtc::Threads of its own, so the thread
+ * count no longer grows with the number of mixers. Threads are handed out least used first.
+ */
+class MixerThreadPool
+{
+    DECLARE_LOGGER();
+
+public:
+    static MixerThreadPool *getInstance();
+    ~MixerThreadPool();
+
+    void start(unsigned int num_threads);
+    void close();
+
+    // Every acquire() is matched by a release() once nothing runs on the thread any more. A
+    // pool that was not started starts with kDefaultThreadNum threads.
+    rtc::Thread *acquire();
+    void release(rtc::Thread *thread);
+
+private:
+    static constexpr unsigned int kDefaultThreadNum = 2;
+
+    struct PooledThread
+    {
+        std::unique_ptr<rtc::Thread> thread;
+        int users = 0;
+    };
+
+    MixerThreadPool();
+    void startThreads(unsigned int num_threads);
+
+    std::vector<PooledThread> threads_;
+    std::mutex mutex_;
+};
+
+} // namespace erizo
+#endif // ERIZO_SRC_ERIZO_MEDIA_MIXERS_MIXERTHREADPOOL_H_
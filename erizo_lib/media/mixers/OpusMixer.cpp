@@ -0,0 +1,567 @@
+#include "media/mixers/OpusMixer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "lib/ClockUtils.h"
+#include "lib/MpscRing.h"
+#include "rtp/RtpHeaders.h"
+#include "rtp/RtpUtils.h"
+
+namespace erizo
+{
+
+DEFINE_LOGGER(OpusMixer, "OpusMixer");
+
+constexpr int OpusMixer::kSampleRate;
+constexpr int OpusMixer::kChannels;
+constexpr int OpusMixer::kFrameMs;
+constexpr int OpusMixer::kFrameSamples;
+constexpr uint8_t OpusMixer::kPayloadType;
+
+static constexpr size_t kInputQueueSize = 256;
+// longest Opus packet is 120 ms
+static constexpr int kMaxDecodedSamples = OpusMixer::kSampleRate / 1000 * 120;
+// an input starts playing once this much audio is buffered, and again after each underrun
+static constexpr int kPrebufferMs = 40;
+// older audio is dropped beyond this, to bound the latency a burst can add
+static constexpr int kMaxBufferedMs = 200;
+// gaps up to this many packets are concealed by the decoder, larger ones are skipped
+static constexpr int kMaxConcealedPackets = 3;
+// A packet this far behind the last one, or this many late packets in a row, means the sender
+// restarted its sequence numbers (reconnect, bridge set up again): decode from scratch
+static constexpr int kMaxLateGap = 100;
+static constexpr int kMaxLatePackets = 10;
+static constexpr int kOutputBitrate = 64000;
+// audio_gain in Q12, so that gains up to 8.0 fit in an int16_t factor
+static constexpr int kGainShift = 12;
+static constexpr int kUnityGain = 1 << kGainShift;
+
+struct OpusMixer::Input
+{
+    explicit Input(const Layer &layer) : packets{kInputQueueSize}, dropped_packets{0}
+    {
+        stream_id = layer.bridge_stream.id;
+        double gain = std::max(0.0, std::min(layer.audio_gain, 32767.0 / kUnityGain));
+        gain_q12 = static_cast<int16_t>(gain * kUnityGain + 0.5);
+    }
+
+    // the last snapshot holding the input, possibly the mixing thread's, destroys the decoder
+    ~Input()
+    {
+        if(decoder) {
+            opus_decoder_destroy(decoder);
+        }
+    }
+
+    std::string stream_id;
+    int16_t gain_q12;
+    // number of layers showing this stream
+    int layers = 1;
+    MpscRing<std::shared_ptr<DataPacket>> packets;
+    std::atomic<uint64_t> dropped_packets;
+
+    // mixing thread only
+    OpusDecoder *decoder = nullptr;
+    std::vector<int16_t> buffered;
+    bool playing = false;
+    bool has_sequence = false;
+    uint16_t last_sequence = 0;
+    int late_packets = 0;
+    // this frame's samples after gain, valid when mixed is set
+    std::vector<int16_t> frame;
+    bool mixed = false;
+};
+
+struct OpusMixer::Output
+{
+    ~Output()
+    {
+        if(encoder) {
+            opus_encoder_destroy(encoder);
+        }
+    }
+
+    // bridge streams left out of this output, none for the full mix
+    std::vector<std::string> input_ids;
+    PacketSink sink;
+
+    // mixing thread only
+    OpusEncoder *encoder = nullptr;
+    uint16_t sequence_number = 0;
+    uint32_t timestamp = 0;
+};
+
+// dst[i] = saturate(src[i] * gain_q12 >> 12)
+static void scaleSamples(const int16_t *src, int16_t *dst, int count, int16_t gain_q12)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i gain = _mm_set1_epi16(gain_q12);
+    const __m128i round = _mm_set1_epi32(1 << (kGainShift - 1));
+    for(; i + 8 <= count; i += 8) {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i low = _mm_mullo_epi16(samples, gain);
+        __m128i high = _mm_mulhi_epi16(samples, gain);
+        __m128i first = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(low, high), round), kGainShift);
+        __m128i second = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(low, high), round), kGainShift);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(first, second));
+    }
+#endif
+    for(; i < count; i++) {
+        int32_t sample = (src[i] * gain_q12 + (1 << (kGainShift - 1))) >> kGainShift;
+        dst[i] = static_cast<int16_t>(std::max(-32768, std::min(32767, sample)));
+    }
+}
+
+// sum[i] += src[i], in 32 bits so that nothing clips before the outputs are derived
+static void accumulateSamples(int32_t *sum, const int16_t *src, int count)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    for(; i + 8 <= count; i += 8) {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        // sign extend by placing each sample in the high half and shifting it back down
+        __m128i first = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        __m128i second = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+        __m128i *dst = reinterpret_cast<__m128i*>(sum + i);
+        _mm_storeu_si128(dst, _mm_add_epi32(_mm_loadu_si128(dst), first));
+        _mm_storeu_si128(dst + 1, _mm_add_epi32(_mm_loadu_si128(dst + 1), second));
+    }
+#endif
+    for(; i < count; i++) {
+        sum[i] += src[i];
+    }
+}
+
+// sum[i] -= src[i]
+static void deductSamples(int32_t *sum, const int16_t *src, int count)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    for(; i + 8 <= count; i += 8) {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i first = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        __m128i second = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+        __m128i *dst = reinterpret_cast<__m128i*>(sum + i);
+        _mm_storeu_si128(dst, _mm_sub_epi32(_mm_loadu_si128(dst), first));
+        _mm_storeu_si128(dst + 1, _mm_sub_epi32(_mm_loadu_si128(dst + 1), second));
+    }
+#endif
+    for(; i < count; i++) {
+        sum[i] -= src[i];
+    }
+}
+
+// dst[i] = saturate(sum[i] - src[i]), or saturate(sum[i]) when src is null
+static void subtractSamples(const int32_t *sum, const int16_t *src, int16_t *dst, int count)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    for(; i + 8 <= count; i += 8) {
+        __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sum + i));
+        __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sum + i + 4));
+        if(src) {
+            __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            first = _mm_sub_epi32(first, _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+            second = _mm_sub_epi32(second, _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(first, second));
+    }
+#endif
+    for(; i < count; i++) {
+        int32_t sample = src ? sum[i] - src[i] : sum[i];
+        dst[i] = static_cast<int16_t>(std::max(-32768, std::min(32767, sample)));
+    }
+}
+
+OpusMixer::OpusMixer()
+{
+}
+
+OpusMixer::~OpusMixer()
+{
+    close();
+}
+
+int OpusMixer::init(const Mixer &mixer, PacketSink sink)
+{
+    if(initialized_) {
+        return 0;
+    }
+    mixer_ = mixer;
+
+    mix_output_ = createOutput(sink);
+    if(!mix_output_) {
+        return -1;
+    }
+
+    sum_.resize(kFrameSamples * kChannels);
+    mix_.resize(kFrameSamples * kChannels);
+    minus_one_.resize(kFrameSamples * kChannels);
+    own_sum_.resize(kFrameSamples * kChannels);
+    decoded_.resize(kMaxDecodedSamples * kChannels);
+
+    for(const auto &layer : mixer_.layers) {
+        addLayer(layer);
+    }
+
+    exit_ = false;
+    initialized_ = true;
+    mix_thread_ = std::make_shared<std::thread>(std::bind(&OpusMixer::mixLoop, this));
+    return 0;
+}
+
+void OpusMixer::close()
+{
+    if(!initialized_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lck(exit_mutex_);
+        exit_ = true;
+    }
+    exit_cv_.notify_all();
+    if(mix_thread_) {
+        mix_thread_->join();
+        mix_thread_.reset();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(layers_mutex_);
+        std::atomic_store(&inputs_, std::shared_ptr<const InputMap>());
+        std::atomic_store(&outputs_, std::shared_ptr<const OutputMap>());
+    }
+
+    mix_output_.reset();
+    initialized_ = false;
+}
+
+std::shared_ptr<OpusMixer::Output> OpusMixer::createOutput(PacketSink sink)
+{
+    std::shared_ptr<Output> output = std::make_shared<Output>();
+    int error = 0;
+    output->encoder = opus_encoder_create(kSampleRate, kChannels, OPUS_APPLICATION_VOIP, &error);
+    if(error != OPUS_OK || !output->encoder) {
+        ELOG_ERROR("mixer:%s create opus encoder failed:%d", mixer_.id.c_str(), error);
+        return nullptr;
+    }
+    opus_encoder_ctl(output->encoder, OPUS_SET_BITRATE(kOutputBitrate));
+    opus_encoder_ctl(output->encoder, OPUS_SET_INBAND_FEC(1));
+    output->sink = sink;
+    output->sequence_number = static_cast<uint16_t>(rand());
+    output->timestamp = static_cast<uint32_t>(rand());
+    return output;
+}
+
+int OpusMixer::addOutput(const std::string &output_id, const std::vector<std::string> &input_ids, PacketSink sink)
+{
+    std::shared_ptr<Output> output = createOutput(sink);
+    if(!output) {
+        return -1;
+    }
+    // an input is mixed once however many layers share it, so it must be left out once too
+    output->input_ids = input_ids;
+    std::sort(output->input_ids.begin(), output->input_ids.end());
+    output->input_ids.erase(std::unique(output->input_ids.begin(), output->input_ids.end()), output->input_ids.end());
+
+    std::lock_guard<std::mutex> lock(layers_mutex_);
+    std::shared_ptr<const OutputMap> current = std::atomic_load(&outputs_);
+    std::shared_ptr<OutputMap> outputs = current ? std::make_shared<OutputMap>(*current) : std::make_shared<OutputMap>();
+    (*outputs)[output_id] = output;
+    std::atomic_store(&outputs_, std::shared_ptr<const OutputMap>(std::move(outputs)));
+    return 0;
+}
+
+void OpusMixer::removeOutput(const std::string &output_id)
+{
+    std::lock_guard<std::mutex> lock(layers_mutex_);
+    std::shared_ptr<const OutputMap> current = std::atomic_load(&outputs_);
+    if(!current || current->find(output_id) == current->end()) {
+        return;
+    }
+    std::shared_ptr<OutputMap> outputs = std::make_shared<OutputMap>(*current);
+    outputs->erase(output_id);
+    std::atomic_store(&outputs_, std::shared_ptr<const OutputMap>(std::move(outputs)));
+}
+
+void OpusMixer::addLayer(const Layer &layer)
+{
+    std::lock_guard<std::mutex> lock(layers_mutex_);
+    std::shared_ptr<const InputMap> current = std::atomic_load(&inputs_);
+    std::shared_ptr<InputMap> inputs = std::make_shared<InputMap>();
+    if(current) {
+        *inputs = *current;
+    }
+
+    auto it = inputs->find(layer.bridge_stream.id);
+    if(it != inputs->end()) {
+        it->second->layers++;
+        return;
+    }
+    std::shared_ptr<Input> input = std::make_shared<Input>(layer);
+    input->frame.resize(kFrameSamples * kChannels);
+    int error = 0;
+    input->decoder = opus_decoder_create(kSampleRate, kChannels, &error);
+    if(error != OPUS_OK || !input->decoder) {
+        ELOG_ERROR("mixer:%s create opus decoder for stream:%s failed:%d",
+                   mixer_.id.c_str(), layer.bridge_stream.id.c_str(), error);
+        return;
+    }
+    (*inputs)[layer.bridge_stream.id] = input;
+    std::atomic_store(&inputs_, std::shared_ptr<const InputMap>(std::move(inputs)));
+}
+
+void OpusMixer::removeLayer(const Layer &layer)
+{
+    std::lock_guard<std::mutex> lock(layers_mutex_);
+    std::shared_ptr<const InputMap> current = std::atomic_load(&inputs_);
+    if(!current) {
+        return;
+    }
+    auto it = current->find(layer.bridge_stream.id);
+    if(it == current->end()) {
+        return;
+    }
+    if(--it->second->layers > 0) {
+        return;
+    }
+    std::shared_ptr<InputMap> inputs = std::make_shared<InputMap>(*current);
+    inputs->erase(layer.bridge_stream.id);
+    std::atomic_store(&inputs_, std::shared_ptr<const InputMap>(std::move(inputs)));
+}
+
+uint64_t OpusMixer::getDroppedPackets() const
+{
+    uint64_t dropped = 0;
+    std::shared_ptr<const InputMap> inputs = std::atomic_load(&inputs_);
+    if(inputs) {
+        for(auto &it : *inputs) {
+            dropped += it.second->dropped_packets;
+        }
+    }
+    return dropped;
+}
+
+void OpusMixer::deliverAudioData(std::shared_ptr<DataPacket> packet, const std::string &stream_id)
+{
+    std::shared_ptr<const InputMap> inputs = std::atomic_load(&inputs_);
+    if(!inputs) {
+        return;
+    }
+    auto it = inputs->find(stream_id);
+    if(it == inputs->end()) {
+        return;
+    }
+    RtcpHeader *chead = reinterpret_cast<RtcpHeader*>(packet->data);
+    if(chead->isRtcp()) {
+        return;
+    }
+    if(!it->second->packets.push(std::move(packet))) {
+        it->second->dropped_packets++;
+    }
+}
+
+void OpusMixer::decodePackets(Input &input)
+{
+    std::shared_ptr<DataPacket> packet;
+    while(input.packets.pop(&packet)) {
+        RtpHeader *head = reinterpret_cast<RtpHeader*>(packet->data);
+        if(head->getPayloadType() != kPayloadType) {
+            continue;
+        }
+        int payload_length = packet->length - head->getHeaderLength() - RtpUtils::getPaddingLength(packet);
+        if(payload_length <= 0) {
+            continue;
+        }
+
+        uint16_t sequence = head->getSeqNumber();
+        if(input.has_sequence) {
+            int16_t gap = static_cast<int16_t>(sequence - input.last_sequence);
+            if(gap <= 0 && (gap < -kMaxLateGap || ++input.late_packets > kMaxLatePackets)) {
+                ELOG_INFO("mixer:%s input:%s sequence restarted, %u after %u, resyncing", mixer_.id.c_str(),
+                          input.stream_id.c_str(), sequence, input.last_sequence);
+                opus_decoder_ctl(input.decoder, OPUS_RESET_STATE);
+                input.buffered.clear();
+                input.playing = false;
+                gap = 1;
+            } else if(gap <= 0) {
+                // late or duplicated, its slot has already been played or concealed
+                continue;
+            }
+            input.late_packets = 0;
+            for(int lost = 1; lost < gap && lost <= kMaxConcealedPackets; lost++) {
+                int samples = opus_decode(input.decoder, nullptr, 0, decoded_.data(), kFrameSamples, 0);
+                if(samples > 0) {
+                    input.buffered.insert(input.buffered.end(), decoded_.begin(), decoded_.begin() + samples * kChannels);
+                }
+            }
+        }
+        input.has_sequence = true;
+        input.last_sequence = sequence;
+
+        const unsigned char *payload = reinterpret_cast<const unsigned char*>(packet->data) + head->getHeaderLength();
+        int samples = opus_decode(input.decoder, payload, payload_length, decoded_.data(), kMaxDecodedSamples, 0);
+        if(samples > 0) {
+            input.buffered.insert(input.buffered.end(), decoded_.begin(), decoded_.begin() + samples * kChannels);
+        }
+    }
+
+    size_t max_buffered = kSampleRate / 1000 * kMaxBufferedMs * kChannels;
+    if(input.buffered.size() > max_buffered) {
+        input.buffered.erase(input.buffered.begin(), input.buffered.end() - max_buffered);
+    }
+}
+
+bool OpusMixer::takeFrame(Input &input, int16_t *pcm)
+{
+    size_t frame_size = kFrameSamples * kChannels;
+    if(!input.playing) {
+        if(input.buffered.size() < static_cast<size_t>(kSampleRate / 1000 * kPrebufferMs * kChannels)) {
+            return false;
+        }
+        input.playing = true;
+    }
+    if(input.buffered.size() < frame_size) {
+        // underrun: go quiet and buffer again instead of playing every late packet on its own
+        input.playing = false;
+        return false;
+    }
+    std::copy(input.buffered.begin(), input.buffered.begin() + frame_size, pcm);
+    input.buffered.erase(input.buffered.begin(), input.buffered.begin() + frame_size);
+    return true;
+}
+
+void OpusMixer::mixFrame()
+{
+    std::fill(sum_.begin(), sum_.end(), 0);
+    std::shared_ptr<const InputMap> inputs = std::atomic_load(&inputs_);
+    if(inputs) {
+        for(auto &it : *inputs) {
+            Input &input = *it.second;
+            decodePackets(input);
+            input.mixed = takeFrame(input, input.frame.data());
+            if(!input.mixed) {
+                continue;
+            }
+            if(input.gain_q12 != kUnityGain) {
+                scaleSamples(input.frame.data(), input.frame.data(), input.frame.size(), input.gain_q12);
+            }
+            accumulateSamples(sum_.data(), input.frame.data(), sum_.size());
+        }
+    }
+    subtractSamples(sum_.data(), nullptr, mix_.data(), mix_.size());
+    sendFrame(*mix_output_, mix_.data());
+
+    std::shared_ptr<const OutputMap> outputs = std::atomic_load(&outputs_);
+    if(!outputs) {
+        return;
+    }
+    for(auto &it : *outputs) {
+        Output &output = *it.second;
+        own_inputs_.clear();
+        if(inputs) {
+            for(const std::string &input_id : output.input_ids) {
+                auto input = inputs->find(input_id);
+                if(input != inputs->end() && input->second->mixed) {
+                    own_inputs_.push_back(input->second.get());
+                }
+            }
+        }
+        if(own_inputs_.empty()) {
+            // not heard in this frame, the full mix is already what this participant needs
+            sendFrame(output, mix_.data());
+            continue;
+        }
+        const int32_t *sum = sum_.data();
+        if(own_inputs_.size() > 1) {
+            // several layers of the same participant: take all but the last out in 32 bits
+            std::copy(sum_.begin(), sum_.end(), own_sum_.begin());
+            for(size_t i = 0; i + 1 < own_inputs_.size(); i++) {
+                deductSamples(own_sum_.data(), own_inputs_[i]->frame.data(), own_sum_.size());
+            }
+            sum = own_sum_.data();
+        }
+        subtractSamples(sum, own_inputs_.back()->frame.data(), minus_one_.data(), minus_one_.size());
+        sendFrame(output, minus_one_.data());
+    }
+}
+
+void OpusMixer::sendFrame(Output &output, const int16_t *pcm)
+{
+    char buffer[1500];
+    RtpHeader *head = reinterpret_cast<RtpHeader*>(buffer);
+    memset(buffer, 0, RtpHeader::MIN_SIZE);
+    int encoded = opus_encode(output.encoder, pcm, kFrameSamples,
+                              reinterpret_cast<unsigned char*>(buffer) + RtpHeader::MIN_SIZE,
+                              sizeof(buffer) - RtpHeader::MIN_SIZE);
+    if(encoded <= 0) {
+        ELOG_ERROR("mixer:%s opus encode failed:%d", mixer_.id.c_str(), encoded);
+        output.timestamp += kFrameSamples;
+        return;
+    }
+    head->setVersion(2);
+    head->setPayloadType(kPayloadType);
+    head->setSeqNumber(output.sequence_number++);
+    head->setTimestamp(output.timestamp);
+    head->setSSRC(mixer_.audio_ssrc);
+    output.timestamp += kFrameSamples;
+
+    output.sink(makeDataPacket(1, buffer, RtpHeader::MIN_SIZE + encoded, AUDIO_PACKET, ClockUtils::getCurrentMs()));
+}
+
+void OpusMixer::skipFrame()
+{
+    mix_output_->timestamp += kFrameSamples;
+    std::shared_ptr<const OutputMap> outputs = std::atomic_load(&outputs_);
+    if(outputs) {
+        for(auto &it : *outputs) {
+            it.second->timestamp += kFrameSamples;
+        }
+    }
+}
+
+void OpusMixer::mixLoop()
+{
+    const std::chrono::milliseconds interval(kFrameMs);
+    auto next_tick = std::chrono::steady_clock::now();
+    time_t last_miss_log = 0;
+    while(1) {
+        next_tick += interval;
+        {
+            std::unique_lock<std::mutex> lck(exit_mutex_);
+            exit_cv_.wait_until(lck, next_tick, [this]() { return exit_; });
+            if(exit_) {
+                break;
+            }
+        }
+
+        mixFrame();
+        mixed_frames_++;
+
+        // Ran past the next deadline: skip the frames we missed, their timestamps included, so
+        // that receivers conceal a gap instead of the stream drifting late
+        auto now = std::chrono::steady_clock::now();
+        if(now >= next_tick + interval) {
+            uint64_t missed = 0;
+            while(next_tick + interval <= now) {
+                next_tick += interval;
+                skipFrame();
+                missed++;
+            }
+            missed_frames_ += missed;
+            if(time(NULL) - last_miss_log >= 5) {
+                last_miss_log = time(NULL);
+                ELOG_WARN("mixer:%s missed %llu audio frames, %llu in total",
+                          mixer_.id.c_str(), (unsigned long long)missed, (unsigned long long)missed_frames_.load());
+            }
+        }
+    }
+}
+
+} // namespace erizo
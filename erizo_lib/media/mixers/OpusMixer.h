@@ -0,0 +1,115 @@
+/*
+* OpusMixer.h
+*/
+#ifndef ERIZO_SRC_ERIZO_MEDIA_MIXERS_OPUSMIXER_H_
+#define ERIZO_SRC_ERIZO_MEDIA_MIXERS_OPUSMIXER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "opus/opus.h"
+#include "./MediaDefinitions.h"
+#include "./logger.h"
+#include "media/mixers/mixer.h"
+
+namespace erizo
+{
+
+/*
+ * Audio-only mixer. It decodes the Opus layers with libopus, mixes 20 ms of 48 kHz stereo PCM
+ * with each layer's audio_gain and encodes a single Opus output. Its own thread keeps the
+ * 20 ms cadence on absolute deadlines. It needs no webrtc Call, AudioState, ADM or
+ * AudioMixerImpl.
+ *
+ * Layers that share a bridge stream are mixed once. Each input has a bounded packet queue, so
+ * delivery threads never wait, and a small jitter buffer. Lost packets are concealed by the
+ * Opus decoder.
+ *
+ * Participants that are themselves mixed can get a minus-one output, the mix without their own
+ * voice. The inputs are summed once per frame in 32 bits and each minus-one mix is that sum
+ * less the participant's contributions, so N outputs cost N subtractions rather than N mixes.
+ * Only the encoding is per output.
+ */
+class OpusMixer
+{
+    DECLARE_LOGGER();
+
+public:
+    typedef std::function<void(std::shared_ptr<DataPacket>)> PacketSink;
+
+    static constexpr int kSampleRate = 48000;
+    static constexpr int kChannels = 2;
+    static constexpr int kFrameMs = 20;
+    // samples per channel in one frame
+    static constexpr int kFrameSamples = kSampleRate / 1000 * kFrameMs;
+    static constexpr uint8_t kPayloadType = 111;
+
+    OpusMixer();
+    ~OpusMixer();
+
+    // sink gets every encoded RTP packet, on the mixing thread
+    int init(const Mixer &mixer, PacketSink sink);
+    void close();
+    void addLayer(const Layer &layer);
+    void removeLayer(const Layer &layer);
+    // Any thread, never blocks: the packet is dropped when the input queue is full
+    void deliverAudioData(std::shared_ptr<DataPacket> packet, const std::string &stream_id);
+    // Sends output_id the mix without the inputs of the bridge streams input_ids, e.g. every
+    // layer one participant publishes, through its own encoder. sink is called on the mixing
+    // thread.
+    int addOutput(const std::string &output_id, const std::vector<std::string> &input_ids, PacketSink sink);
+    void removeOutput(const std::string &output_id);
+
+    uint64_t getMixedFrames() const { return mixed_frames_; }
+    uint64_t getMissedFrames() const { return missed_frames_; }
+    uint64_t getDroppedPackets() const;
+
+private:
+    struct Input;
+    struct Output;
+    typedef std::map<std::string, std::shared_ptr<Input>> InputMap;
+    typedef std::map<std::string, std::shared_ptr<Output>> OutputMap;
+
+    void mixLoop();
+    void mixFrame();
+    void decodePackets(Input &input);
+    bool takeFrame(Input &input, int16_t *pcm);
+    std::shared_ptr<Output> createOutput(PacketSink sink);
+    void sendFrame(Output &output, const int16_t *pcm);
+    void skipFrame();
+
+    Mixer mixer_;
+    // the full mix, fanned out to every other subscriber
+    std::shared_ptr<Output> mix_output_;
+    // Copy-on-write: replaced under layers_mutex_, read with std::atomic_load
+    std::shared_ptr<const InputMap> inputs_;
+    std::shared_ptr<const OutputMap> outputs_;
+    std::mutex layers_mutex_;
+
+    std::vector<int32_t> sum_;
+    std::vector<int16_t> mix_;
+    std::vector<int16_t> minus_one_;
+    // the sum less all but one of a participant's inputs, when it has several
+    std::vector<int32_t> own_sum_;
+    std::vector<const Input*> own_inputs_;
+    std::vector<int16_t> decoded_;
+
+    std::shared_ptr<std::thread> mix_thread_;
+    bool exit_ = false;
+    std::mutex exit_mutex_;
+    std::condition_variable exit_cv_;
+    bool initialized_ = false;
+    std::atomic<uint64_t> mixed_frames_{0};
+    std::atomic<uint64_t> missed_frames_{0};
+};
+
+} // namespace erizo
+#endif // ERIZO_SRC_ERIZO_MEDIA_MIXERS_OPUSMIXER_H_
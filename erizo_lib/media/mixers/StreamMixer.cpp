@@ -1,5 +1,7 @@
 #include "StreamMixer.h"
 
+#include <set>
+
 #include "BridgeIO.h"
 #include "rtp/BridgeRtpRetransmissionHandler.h"
 #include "lib/ClockUtils.h"
@@ -23,11 +25,10 @@
 #include "media/engine/webrtc_video_engine.h"
 #include "api/video/video_frame_buffer.h"
 #include "api/video/i420_buffer.h"
+#include "media/mixers/I420Compositor.h"
+#include "thread/CompositorPool.h"
+#include "media/mixers/MixerThreadPool.h"
 //-Wno-error=overloaded-virtual -Wno-error=return-type
-#include <opencv2/core.hpp>
-#include <opencv2/core/mat.hpp>
-#include <opencv2/opencv.hpp>
-#include <opencv2/imgproc/imgproc.hpp>
 #include "modules/rtp_rtcp/source/rtp_packet.h"
 #include "OneToManyProcessor.h"
 #include "rtp/RtpUtils.h"
@@ -50,11 +51,16 @@ enum : int {  // The first valid value is 1.
   kVideoRotationRtpExtensionId,
 };
 
+constexpr size_t MixStream::kIngressQueueSize;
+constexpr int MixStream::kIngressBatch;
+
 MixStream::MixStream(const Layer &layer, 
-                     cricket::MediaEngineInterface *media_engine)
+                     const MixStreamContext &context) : worker_thread_{context.worker_thread}, ingress_{kIngressQueueSize},
+                     closed_{false}, drain_scheduled_{false}, delivered_packets_{0}, dropped_packets_{0}
 {
     layer_ = layer;
-    media_engine_ = media_engine;
+    context_ = context;
+    call_ = context.call;
 }
 
 bool MixStream::init()
@@ -63,23 +69,11 @@ bool MixStream::init()
         return true;
     }
     
-    audio_decoder_factory_ = webrtc::CreateBuiltinAudioDecoderFactory();
-    video_decoder_factory_ = webrtc::CreateBuiltinVideoDecoderFactory();
-
-    rtc_event_log_ = webrtc::RtcEventLog::CreateNull();
-    // rtc_event_log_ = webrtc::RtcEventLog::Create(webrtc::RtcEventLog::EncodingType::Legacy);
-    // bool event_log_started = rtc_event_log_->StartLogging(absl::make_unique<webrtc::RtcEventLogOutputFile>(
-    //                                                       "/home/jiangbaolin/webrtc_recv.log", webrtc::RtcEventLog::kUnlimitedOutput),
-    //                                                      webrtc::RtcEventLog::kImmediateOutput);
-
-    webrtc::Call::Config call_config(rtc_event_log_.get());
-    call_config.audio_state = media_engine_->voice().GetAudioState();
-    call_.reset(webrtc::CreateCallFactory()->CreateCall(call_config));
     if(!call_) {
-        ELOG_ERROR("create recv call for stream:%s failed.", layer_.stream_id.c_str());
+        ELOG_ERROR("no recv call for stream:%s.", layer_.stream_id.c_str());
         return false;
     }
-    
+
     webrtc::VideoReceiveStream::Config video_config(this);
     video_config.rtp.remb = true;
     video_config.rtp.transport_cc = false;
@@ -91,7 +85,7 @@ bool MixStream::init()
     webrtc::VideoReceiveStream::Decoder h264_decoder;
     h264_decoder.payload_type = 101;
     h264_decoder.video_format = webrtc::SdpVideoFormat("H264");
-    h264_decoder.decoder_factory = video_decoder_factory_.get();
+    h264_decoder.decoder_factory = context_.video_decoder_factory;
     video_config.decoders.push_back(h264_decoder);
 
     video_recv_stream_ = call_->CreateVideoReceiveStream(video_config.Copy());
@@ -102,7 +96,7 @@ bool MixStream::init()
 
     webrtc::AudioReceiveStream::Config audio_config;
     audio_config.rtp.local_ssrc = 0x123456;
-    audio_config.decoder_factory = audio_decoder_factory_;
+    audio_config.decoder_factory = context_.audio_decoder_factory;
     audio_config.rtcp_send_transport = this;
     audio_config.rtp.remote_ssrc = layer_.audio_ssrc;
     audio_config.rtp.transport_cc = false;
@@ -125,6 +119,10 @@ void MixStream::close()
     if(!initialized_)
         return;
 
+    // refuse new packets before dropping the drain tasks already posted
+    closed_ = true;
+    invoker_.Clear();
+
     if(video_recv_stream_) {
         video_recv_stream_->Stop();
     }
@@ -140,8 +138,8 @@ void MixStream::close()
     if(call_ && video_recv_stream_) {
         call_->DestroyVideoReceiveStream(video_recv_stream_);
     }
-
-    call_.reset();
+    audio_recv_stream_ = nullptr;
+    video_recv_stream_ = nullptr;
     call_ = nullptr;
 
     initialized_ = false;
@@ -153,61 +151,17 @@ void MixStream::OnFrame(const webrtc::VideoFrame& frame) {
 		buffer = webrtc::I420Buffer::Rotate(*buffer, frame.rotation());
 	}
 
-    int width = frame.width();
-    int height = frame.height();
-    int mwh = width*height;
-    std::lock_guard<std::mutex> lck(buf_mutex_);
-    if(!yuv420_buf_ || width_ != width || height_ != height) {
-        yuv420_buf_.reset();
-        yuv420_buf_ = nullptr;
-        yuv420_buf_ = std::shared_ptr<char>(new char[mwh*3/2]);
-        width_ = width;
-        height_ = height;
-    }
-
-    //copy y
-    char *y_start = yuv420_buf_.get();
-    if(buffer->StrideY() != width) {
-        for(int i = 0; i < height; i++) {
-            memcpy(y_start + i*width, (char*)buffer->DataY() + buffer->StrideY()*i, width);
-        }
-    } else {
-        memcpy(y_start, (char*)buffer->DataY(), buffer->StrideY()*height);
-    }
-
-    int uv_height = (height+1)/2;
-    int uv_width = (width+1)/2;
-    //copy u
-    char *u_start = yuv420_buf_.get() + mwh;
-    if(buffer->StrideU() != uv_width) {
-        for(int i = 0; i < uv_height; i++) {
-            memcpy(u_start + i*uv_width, (char*)buffer->DataU() + buffer->StrideU()*i, uv_width);
-        }
-    } else {
-        memcpy(u_start, (char*)buffer->DataU(), buffer->StrideU()*uv_height);
-    }
-    //copy v
-    char *v_start = yuv420_buf_.get() + mwh*5/4;
-    if(buffer->StrideV() != uv_width) {
-        for(int i = 0; i < uv_height; i++) {
-            memcpy(v_start + i*uv_width, (char*)buffer->DataV() + buffer->StrideV()*i, uv_width);
-        }
-    } else {
-        memcpy(v_start, (char*)buffer->DataV(), buffer->StrideV()*uv_height);
-    }
-
-    frame_count_++;
+    // The decoded buffer is refcounted and never written again, so it is published as is; the
+    // decoder takes another buffer from its pool while the mixer still reads this one
+    auto decoded = std::make_shared<DecodedFrame>();
+    decoded->buffer = buffer;
+    decoded->sequence = ++frame_count_;
+    std::atomic_store(&latest_frame_, std::shared_ptr<const DecodedFrame>(std::move(decoded)));
 }
 
-std::tuple<std::shared_ptr<char>, int, int> MixStream::getVideoData()
+std::shared_ptr<const DecodedFrame> MixStream::getLatestFrame()
 {
-    std::lock_guard<std::mutex> lck(buf_mutex_);
-    if(width_ == 0 || height_ == 0) {
-        return std::make_tuple(nullptr, width_, height_);
-    }
-    std::shared_ptr<char> temp_buf = std::shared_ptr<char>(new char[width_*height_*3/2]);
-    memcpy(temp_buf.get(), yuv420_buf_.get(), width_*height_*3/2);
-    return std::make_tuple(temp_buf, width_, height_);
+    return std::atomic_load(&latest_frame_);
 }
 
 int MixStream::DeliverPacket(webrtc::MediaType media_type,
@@ -224,6 +178,49 @@ int MixStream::DeliverPacket(webrtc::MediaType media_type,
     return -2;
 }
 
+bool MixStream::enqueuePacket(webrtc::MediaType media_type,
+                              std::shared_ptr<DataPacket> data_packet)
+{
+    if(closed_) {
+        return false;
+    }
+    IngressPacket ingress;
+    ingress.media_type = media_type;
+    ingress.packet = std::move(data_packet);
+    if(!ingress_.push(std::move(ingress))) {
+        dropped_packets_++;
+        return false;
+    }
+    scheduleDrain();
+    return true;
+}
+
+void MixStream::scheduleDrain()
+{
+    // at most one drain task in flight, producers that find one pending only queue
+    if(!drain_scheduled_.exchange(true)) {
+        invoker_.AsyncInvoke<void>(RTC_FROM_HERE, worker_thread_, [this]() {
+            drainIngress();
+        });
+    }
+}
+
+void MixStream::drainIngress()
+{
+    // cleared before popping, so a packet pushed after the last pop schedules a new drain
+    drain_scheduled_.store(false);
+    IngressPacket ingress;
+    int delivered = 0;
+    while(ingress_.pop(&ingress)) {
+        DeliverPacket(ingress.media_type, std::move(ingress.packet));
+        delivered_packets_++;
+        if(++delivered >= kIngressBatch) {
+            scheduleDrain();
+            return;
+        }
+    }
+}
+
 bool MixStream::SendRtp(const uint8_t* packet,
                         size_t length,
                         const webrtc::PacketOptions& options)
@@ -237,7 +234,7 @@ bool MixStream::SendRtcp(const uint8_t* packet, size_t length)
         RtcpHeader *chead = reinterpret_cast<RtcpHeader*> ((char*)packet);
 
         ELOG_ERROR("****************************deliver rtcp back type=%d************************************", chead->getPacketType());
-        std::shared_ptr<erizo::DataPacket> ez_packet = std::make_shared<erizo::DataPacket>(1, 
+        std::shared_ptr<erizo::DataPacket> ez_packet = erizo::makeDataPacket(1, 
                                                         (const char*)packet, length, erizo::OTHER_PACKET, ClockUtils::getCurrentMs());
         layer_.bridge_feedback_sink->deliverFeedback(ez_packet, layer_.bridge_stream.id);
         return true;
@@ -306,6 +303,7 @@ int StreamMixer::init(const Mixer &mixer)
         return a.index > b.index;
     };
     std::sort(mixer_.layers.begin(), mixer_.layers.end(), layer_sort);
+    publishLayers();
 
     otm_processor_ = std::make_shared<erizo::OneToManyProcessor>();
     source_fb_sink_ = this;
@@ -316,9 +314,35 @@ int StreamMixer::init(const Mixer &mixer)
     video_sink_ssrc_ = mixer_.video_ssrc;
     audio_sink_ssrc_ = mixer_.audio_ssrc;
     setVideoSourceSSRC(mixer_.video_ssrc);
+    simulcast_ssrcs_.clear();
+    if(!mixer_.renditions.empty()) {
+        // the full canvas keeps mixer.video_ssrc as first source ssrc, subscribers are bound to it
+        std::vector<uint32_t> source_ssrcs = {mixer_.video_ssrc};
+        for(auto &rendition : mixer_.renditions) {
+            simulcast_ssrcs_.push_back(rendition.video_ssrc);
+            source_ssrcs.push_back(rendition.video_ssrc);
+        }
+        simulcast_ssrcs_.push_back(mixer_.video_ssrc);
+        setVideoSourceSSRCList(source_ssrcs);
+    }
     setAudioSourceSSRC(mixer_.audio_ssrc);
     otm_processor_->setPublisher(shared_from_this());
 
+    if(mixer_.audio_only) {
+        // no canvas to compose, skip the webrtc calls and mix the opus layers directly
+        opus_mixer_.reset(new OpusMixer());
+        int ret = opus_mixer_->init(mixer_, [this](std::shared_ptr<DataPacket> packet) {
+            otm_processor_->deliverAudioData(std::move(packet), mixer_.id);
+        });
+        if(0 != ret) {
+            ELOG_ERROR("init opus mixer failed.");
+            opus_mixer_.reset();
+            return -3;
+        }
+        initialized_ = true;
+        return 0;
+    }
+
     if(0 != createSendStream()) {
         ELOG_ERROR("create send stream failed.");
         return -1;
@@ -340,19 +364,31 @@ void StreamMixer::addMixerLayer(const Layer &layer)
         return;
     }
 
+    if(opus_mixer_) {
+        opus_mixer_->addLayer(layer);
+        mixer_.layers.push_back(layer);
+        publishLayers();
+        return;
+    }
+
     if(!recv_worker_thread_) {
         return;
     }
 
     int ret = recv_worker_thread_->Invoke<int>(RTC_FROM_HERE, [=, &layer]() {
-        if(mix_streams_.find(layer.bridge_stream.id) == mix_streams_.end()) {
-            std::shared_ptr<MixStream> mix_stream = std::make_shared<MixStream>(layer, recv_media_engine_.get());
+        if(!findMixStream(layer.bridge_stream.id)) {
+            std::shared_ptr<MixStream> mix_stream = std::make_shared<MixStream>(layer, mixStreamContext());
             if(!mix_stream->init()) {
                 return -1;
             }
 
-            mix_streams_.insert(std::make_pair(layer.bridge_stream.id, mix_stream));
+            addMixStream(layer.bridge_stream.id, mix_stream);
             mixer_.layers.emplace_back(std::move(layer));
+            // keep the paint order of mixFrame
+            std::stable_sort(mixer_.layers.begin(), mixer_.layers.end(), [](const Layer &a, const Layer &b) {
+                return a.index > b.index;
+            });
+            publishLayers();
             return 0;
         }
         return -2;
@@ -365,37 +401,49 @@ void StreamMixer::removeMixerLayer(const Layer &layer)
         return;
     }
 
+    if(opus_mixer_) {
+        opus_mixer_->removeLayer(layer);
+        auto it = std::find_if(mixer_.layers.begin(), mixer_.layers.end(), [&layer](const Layer &l) {
+            return l.stream_id == layer.stream_id && l.index == layer.index;
+        });
+        if(it != mixer_.layers.end()) {
+            mixer_.layers.erase(it);
+            publishLayers();
+        }
+        return;
+    }
+
     if(!recv_worker_thread_) {
         return;
     }
 
     int ret = recv_worker_thread_->Invoke<int>(RTC_FROM_HERE, [=, &layer]() {
+        // other layers may show the same bridge stream, its MixStream stays until the last one goes
         auto find_stream = [&layer](const Layer &l){
-            return l.stream_id == layer.stream_id && l.index == layer.index;
+            return l.bridge_stream.id == layer.bridge_stream.id;
         };
 
         int stream_used_count = std::count_if(mixer_.layers.begin(), mixer_.layers.end(), find_stream);
         if(stream_used_count <= 1) {
-            auto it_mix_stream = mix_streams_.find(layer.bridge_stream.id);
-            if(it_mix_stream != mix_streams_.end()) {
-                it_mix_stream->second->close();
-                mix_streams_.erase(layer.bridge_stream.id);
+            std::shared_ptr<MixStream> mix_stream = findMixStream(layer.bridge_stream.id);
+            if(mix_stream) {
+                mix_stream->close();
+                removeMixStream(layer.bridge_stream.id);
             }
         }
 
         auto remove_layer = [&layer](const Layer &l) {
             return l.stream_id == layer.stream_id && l.index == layer.index;
         };
-        std::remove_if(mixer_.layers.begin(), mixer_.layers.end(), remove_layer);
+        mixer_.layers.erase(std::remove_if(mixer_.layers.begin(), mixer_.layers.end(), remove_layer), mixer_.layers.end());
+        publishLayers();
         return 0;
     });
 }
 
 int StreamMixer::createSendStream()
 {
-    send_worker_thread_  = rtc::Thread::Create();
-    send_worker_thread_->SetName("send_worker_thread", nullptr);
-    send_worker_thread_->Start();
+    send_worker_thread_ = MixerThreadPool::getInstance()->acquire();
 
     int ret = send_worker_thread_->Invoke<int>(RTC_FROM_HERE, [=]() {
         send_adm_ = webrtc::AudioDeviceModule::Create(webrtc::AudioDeviceModule::kPlatformDefaultAudio);
@@ -421,13 +469,13 @@ int StreamMixer::createSendStream()
         }
         call_config.bitrate_config.min_bitrate_bps = 70000;
         call_config.bitrate_config.start_bitrate_bps = 400000;
-        call_config.bitrate_config.max_bitrate_bps = 3000000;
+        call_config.bitrate_config.max_bitrate_bps = std::max(3000000, totalVideoBitrateBps() + 65000);
         send_call_.reset(webrtc::CreateCallFactory()->CreateCall(call_config));
 
         webrtc::BitrateConstraints bitrate_config;
         bitrate_config.min_bitrate_bps = 70000;
         bitrate_config.start_bitrate_bps = 400000;
-        bitrate_config.max_bitrate_bps = 3000000;
+        bitrate_config.max_bitrate_bps = std::max(3000000, totalVideoBitrateBps() + 65000);
         send_call_->GetTransportControllerSend()->SetSdpBitrateParameters(bitrate_config);
         
         webrtc::AudioSendStream::Config audio_send_config(this);
@@ -456,21 +504,32 @@ int StreamMixer::createSendStream()
         video_send_config.encoder_settings.bitrate_allocator_factory = bitrate_allocator_factory_.get();
         video_send_config.rtp.payload_name = "H264";
         video_send_config.rtp.payload_type = 101;
-        video_send_config.rtp.ssrcs.push_back(mixer_.video_ssrc);
+        if(simulcast_ssrcs_.empty()) {
+            video_send_config.rtp.ssrcs.push_back(mixer_.video_ssrc);
+        } else {
+            video_send_config.rtp.ssrcs = simulcast_ssrcs_;
+        }
         video_send_config.rtp.extensions = GetVideoRtpExtensions();
 
         webrtc::VideoEncoderConfig video_encoder_config;
         video_encoder_config.content_type = webrtc::VideoEncoderConfig::ContentType::kRealtimeVideo;
         video_encoder_config.codec_type = webrtc::kVideoCodecH264;
-        video_encoder_config.number_of_streams = 1;
+        video_encoder_config.number_of_streams = video_send_config.rtp.ssrcs.size();
         video_encoder_config.max_bitrate_bps = 10000000;
-        video_encoder_config.simulcast_layers = std::vector<webrtc::VideoStream>(1);
+        video_encoder_config.simulcast_layers = std::vector<webrtc::VideoStream>(video_encoder_config.number_of_streams);
+        for(auto &simulcast_layer : video_encoder_config.simulcast_layers) {
+            simulcast_layer.max_framerate = mixer_.fps;
+        }
         video_encoder_config.video_format.name = "H264";
         webrtc::VideoCodecH264 h264 = GetDefaultH264Settings();
         // h264.frameDroppingOn = false;
         video_encoder_config.encoder_specific_settings = new rtc::RefCountedObject<webrtc::VideoEncoderConfig::H264EncoderSpecificSettings>(h264);
         video_encoder_config.encoder_specific_settings->FillVideoCodecH264(&h264);
-        video_encoder_config.video_stream_factory = new rtc::RefCountedObject<cricket::EncoderStreamFactory>("H264", 56, false, false);
+        if(simulcast_ssrcs_.empty()) {
+            video_encoder_config.video_stream_factory = new rtc::RefCountedObject<cricket::EncoderStreamFactory>("H264", 56, false, false);
+        } else {
+            video_encoder_config.video_stream_factory = new rtc::RefCountedObject<RenditionStreamFactory>(mixer_);
+        }
         // video_send_streams_ = video_encoder_config.video_stream_factory->CreateEncoderStreams(mixer_.width, mixer_.height, video_encoder_config);
         // const unsigned char num_temporal_layers = static_cast<unsigned char>(
         // video_send_streams_.back().num_temporal_layers.value_or(1));
@@ -500,9 +559,7 @@ int StreamMixer::createRecvStreams()
         ELOG_ERROR("please create send thread before create recv streams.");
         return -1;
     }
-    recv_worker_thread_ = rtc::Thread::Create();
-    recv_worker_thread_->SetName("recv_worker_thread", nullptr);
-	recv_worker_thread_->Start();
+    recv_worker_thread_ = MixerThreadPool::getInstance()->acquire();
 
     int ret = recv_worker_thread_->Invoke<int>(RTC_FROM_HERE, [=]() {
         recv_adm_ = webrtc::AudioDeviceModule::Create(webrtc::AudioDeviceModule::kPlatformDefaultAudio);
@@ -521,17 +578,30 @@ int StreamMixer::createRecvStreams()
             return -3;
         }
 
+        // One receive Call for all layers: it demuxes their packets by ssrc, and layers share
+        // its event log, decoder factories and threads
+        recv_event_log_ = webrtc::RtcEventLog::CreateNull();
+        webrtc::Call::Config call_config(recv_event_log_.get());
+        call_config.audio_state = recv_media_engine_->voice().GetAudioState();
+        recv_call_.reset(webrtc::CreateCallFactory()->CreateCall(call_config));
+        if(!recv_call_) {
+            ELOG_ERROR("create recv call failed.");
+            return -5;
+        }
+        audio_decoder_factory_ = webrtc::CreateBuiltinAudioDecoderFactory();
+        video_decoder_factory_ = webrtc::CreateBuiltinVideoDecoderFactory();
+
         for(const auto &layer : mixer_.layers) {
-            if(mix_streams_.find(layer.bridge_stream.id) != mix_streams_.end()) {
+            if(findMixStream(layer.bridge_stream.id)) {
                 continue;
             }
 
-            std::shared_ptr<MixStream> mix_stream = std::make_shared<MixStream>(layer, recv_media_engine_.get());
+            std::shared_ptr<MixStream> mix_stream = std::make_shared<MixStream>(layer, mixStreamContext());
             if(!mix_stream->init()) {
                 return -4;
             }
 
-            mix_streams_.insert(std::make_pair(layer.bridge_stream.id, mix_stream));
+            addMixStream(layer.bridge_stream.id, mix_stream);
         }
 
         recv_adm_->OnPlayout([=](int64_t timestamp, const char *data, size_t len, size_t sample_rate, size_t channel_num, size_t samples) {
@@ -556,6 +626,16 @@ int StreamMixer::createRecvStreams()
     return ret;
 }
 
+MixStreamContext StreamMixer::mixStreamContext()
+{
+    MixStreamContext context;
+    context.call = recv_call_.get();
+    context.audio_decoder_factory = audio_decoder_factory_;
+    context.video_decoder_factory = video_decoder_factory_.get();
+    context.worker_thread = recv_worker_thread_;
+    return context;
+}
+
 int StreamMixer::removeRecvStreams()
 {
     if(!recv_worker_thread_) {
@@ -564,10 +644,18 @@ int StreamMixer::removeRecvStreams()
     }
 
     int ret = recv_worker_thread_->Invoke<int>(RTC_FROM_HERE, [=]() {
-        for(auto it : mix_streams_) {
-           it.second->close();
+        std::shared_ptr<const MixStreamMap> mix_streams = std::atomic_load(&mix_streams_);
+        if(mix_streams) {
+            for(auto it : *mix_streams) {
+               it.second->close();
+            }
         }
-        mix_streams_.clear();
+        std::atomic_store(&mix_streams_, std::shared_ptr<const MixStreamMap>());
+
+        recv_call_.reset();
+        recv_event_log_.reset();
+        audio_decoder_factory_ = nullptr;
+        video_decoder_factory_.reset();
 
         recv_media_engine_.reset();
         recv_media_engine_ = nullptr;
@@ -578,7 +666,8 @@ int StreamMixer::removeRecvStreams()
         return 0;
     });
 
-    recv_worker_thread_->Stop();
+    MixerThreadPool::getInstance()->release(recv_worker_thread_);
+    recv_worker_thread_ = nullptr;
     return ret;
 }
 
@@ -625,7 +714,8 @@ int StreamMixer::removeSendStream()
         return 0;
     });
 
-    send_worker_thread_->Stop();
+    MixerThreadPool::getInstance()->release(send_worker_thread_);
+    send_worker_thread_ = nullptr;
     return ret;
 }
 
@@ -634,6 +724,27 @@ void StreamMixer::addSubscriber(const std::string &client_id, std::shared_ptr<er
     if (otm_processor_ != nullptr)
     {
         std::string subscriber_id = (client_id + "_") + mixer_.id;
+        if(opus_mixer_) {
+            // a participant of the mix hears everybody but itself, in every layer it publishes
+            std::vector<std::string> own_streams;
+            for(const auto &layer : mixer_.layers) {
+                if(!layer.client_id.empty() && layer.client_id == client_id) {
+                    own_streams.push_back(layer.bridge_stream.id);
+                }
+            }
+            if(!own_streams.empty()) {
+                media_stream->setAudioSinkSSRC(mixer_.audio_ssrc);
+                media_stream->setVideoSinkSSRC(mixer_.video_ssrc);
+                std::string mixer_id = mixer_.id;
+                int ret = opus_mixer_->addOutput(subscriber_id, own_streams, [media_stream, mixer_id](std::shared_ptr<DataPacket> packet) {
+                    media_stream->deliverAudioData(std::move(packet), mixer_id);
+                });
+                if(0 == ret) {
+                    return;
+                }
+                ELOG_ERROR("mixer:%s add minus-one output for client:%s failed", mixer_.id.c_str(), client_id.c_str());
+            }
+        }
         otm_processor_->addSubscriber(media_stream, subscriber_id);
     }
 }
@@ -651,6 +762,9 @@ void StreamMixer::removeSubscriber(const std::string &client_id)
     if (otm_processor_ != nullptr)
     {
         std::string subscriber_id = (client_id + "_") + mixer_.id;
+        if(opus_mixer_) {
+            opus_mixer_->removeOutput(subscriber_id);
+        }
         otm_processor_->removeSubscriber(subscriber_id);
     }
 }
@@ -660,15 +774,197 @@ void StreamMixer::setMediaStreamEventListener(MediaStreamEventListener* listener
     media_stream_event_listener_ = listener;
 }
 
+uint64_t StreamMixer::getDroppedPackets() const
+{
+    uint64_t dropped = 0;
+    if(opus_mixer_) {
+        dropped += opus_mixer_->getDroppedPackets();
+    }
+    std::shared_ptr<const MixStreamMap> mix_streams = std::atomic_load(&mix_streams_);
+    if(mix_streams) {
+        for(auto &it : *mix_streams) {
+            dropped += it.second->getDroppedPackets();
+        }
+    }
+    return dropped;
+}
+
+std::shared_ptr<MixStream> StreamMixer::findMixStream(const std::string &stream_id) const
+{
+    std::shared_ptr<const MixStreamMap> mix_streams = std::atomic_load(&mix_streams_);
+    if(!mix_streams) {
+        return nullptr;
+    }
+    auto it = mix_streams->find(stream_id);
+    if(it == mix_streams->end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+void StreamMixer::addMixStream(const std::string &stream_id, std::shared_ptr<MixStream> mix_stream)
+{
+    std::shared_ptr<MixStreamMap> mix_streams = std::make_shared<MixStreamMap>();
+    std::shared_ptr<const MixStreamMap> current = std::atomic_load(&mix_streams_);
+    if(current) {
+        *mix_streams = *current;
+    }
+    (*mix_streams)[stream_id] = mix_stream;
+    std::atomic_store(&mix_streams_, std::shared_ptr<const MixStreamMap>(std::move(mix_streams)));
+}
+
+void StreamMixer::removeMixStream(const std::string &stream_id)
+{
+    std::shared_ptr<const MixStreamMap> current = std::atomic_load(&mix_streams_);
+    if(!current || current->find(stream_id) == current->end()) {
+        return;
+    }
+    std::shared_ptr<MixStreamMap> mix_streams = std::make_shared<MixStreamMap>(*current);
+    mix_streams->erase(stream_id);
+    std::atomic_store(&mix_streams_, std::shared_ptr<const MixStreamMap>(std::move(mix_streams)));
+}
+
+void StreamMixer::publishLayers()
+{
+    std::atomic_store(&layers_, std::shared_ptr<const LayerList>(std::make_shared<LayerList>(mixer_.layers)));
+}
+
+// Chroma-aligned layer rectangles, as I420Compositor paints them
+static bool layersOverlap(const Layer &a, const Layer &b)
+{
+    int ax = a.off_x & ~1, ay = a.off_y & ~1, aw = a.width & ~1, ah = a.height & ~1;
+    int bx = b.off_x & ~1, by = b.off_y & ~1, bw = b.width & ~1, bh = b.height & ~1;
+    return ax < bx + bw && bx < ax + aw && ay < by + bh && by < ay + ah;
+}
+
+bool StreamMixer::CanvasLayer::operator==(const CanvasLayer &other) const
+{
+    return source == other.source && x == other.x && y == other.y &&
+           width == other.width && height == other.height && alpha == other.alpha;
+}
+
+rtc::scoped_refptr<webrtc::I420Buffer> StreamMixer::composeFrame()
+{
+    // One snapshot per tick: layers added or removed meanwhile show up on the next one
+    std::shared_ptr<const LayerList> snapshot = std::atomic_load(&layers_);
+    if(!snapshot) {
+        snapshot = std::make_shared<LayerList>();
+    }
+    size_t count = snapshot->size();
+    std::vector<CanvasLayer> layout(count);
+    for(size_t i = 0; i < count; i++) {
+        const Layer &layer = (*snapshot)[i];
+        layout[i].x = layer.off_x;
+        layout[i].y = layer.off_y;
+        layout[i].width = layer.width;
+        layout[i].height = layer.height;
+        layout[i].alpha = layer.alpha;
+        std::shared_ptr<MixStream> mix_stream = findMixStream(layer.bridge_stream.id);
+        if(!mix_stream) {
+            ELOG_ERROR("could not find stream:%s", layer.bridge_stream.id.c_str());
+            continue;
+        }
+        layout[i].source = mix_stream->getLatestFrame();
+        if(!layout[i].source) {
+            ELOG_ERROR("====================== could not get video data of %s =====================", layer.stream_id.c_str());
+        }
+    }
+
+    // No tile has a new frame and the layout is the same: the last canvas is still exact. It
+    // was never written after being sent, so it can be sent again.
+    if(last_canvas_ && layout == last_layout_) {
+        return last_canvas_;
+    }
+
+    // Overlapping layers end up in one group that a single task paints in z-order. Different
+    // groups never touch the same pixels, so they are painted in parallel.
+    std::vector<size_t> group(count);
+    for(size_t i = 0; i < count; i++) {
+        group[i] = i;
+    }
+    auto find_group = [&group](size_t i) {
+        while(group[i] != i) {
+            group[i] = group[group[i]];
+            i = group[i];
+        }
+        return i;
+    };
+    for(size_t i = 0; i < count; i++) {
+        for(size_t j = i + 1; j < count; j++) {
+            if(layout[i].source && layout[j].source && layersOverlap((*snapshot)[i], (*snapshot)[j])) {
+                group[find_group(j)] = find_group(i);
+            }
+        }
+    }
+    std::map<size_t, std::vector<size_t>> groups;
+    for(size_t i = 0; i < count; i++) {
+        if(layout[i].source) {
+            groups[find_group(i)].push_back(i);
+        }
+    }
+
+    // Caches follow their layer, wherever it moves in the list. All entries are created here,
+    // so the tasks below only use them and never change the map.
+    std::vector<ScaledLayer*> cached_layers(count);
+    std::set<LayerKey> keys;
+    for(size_t i = 0; i < count; i++) {
+        LayerKey key((*snapshot)[i].bridge_stream.id, (*snapshot)[i].index);
+        keys.insert(key);
+        cached_layers[i] = &scaled_cache_[key];
+    }
+    for(auto it = scaled_cache_.begin(); it != scaled_cache_.end();) {
+        if(keys.count(it->first) == 0) {
+            it = scaled_cache_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    // A buffer the encoder still holds is never handed out again, so the canvas goes to
+    // the send stream as is
+    rtc::scoped_refptr<webrtc::I420Buffer> canvas = frame_pool_.CreateBuffer(mixer_.width, mixer_.height);
+    I420Compositor::clear(canvas.get());
+    std::vector<CompositorPool::Task> tasks;
+    for(auto &members : groups) {
+        std::vector<size_t> layers = std::move(members.second);
+        webrtc::I420Buffer *target = canvas.get();
+        tasks.push_back([target, &layout, &cached_layers, layers]() {
+            // layers are sorted by descending index, so lower indexes are painted on top
+            for(size_t i : layers) {
+                const CanvasLayer &layer = layout[i];
+                ScaledLayer &cached = *cached_layers[i];
+                // Tiles without a new frame since the last tick are only re-blitted
+                if(cached.source != layer.source || cached.width != layer.width || cached.height != layer.height) {
+                    I420Compositor::scaleLayer(I420Planes::fromBuffer(*layer.source->buffer),
+                                               layer.width, layer.height, &cached.scaled);
+                    cached.source = layer.source;
+                    cached.width = layer.width;
+                    cached.height = layer.height;
+                }
+                if(cached.scaled) {
+                    I420Compositor::blitLayer(*cached.scaled, layer.x, layer.y, layer.alpha, target);
+                }
+            }
+        });
+    }
+    CompositorPool::getInstance()->runAll(std::move(tasks));
+
+    last_canvas_ = canvas;
+    last_layout_.swap(layout);
+    return canvas;
+}
+
 void StreamMixer::mixFrame() {
-    cv::Mat dst_rgb_img(mixer_.height, mixer_.width, CV_8UC3);
-    cv::Mat dst_yuv_img;
-    int cost_ms = 0;
+    const std::chrono::microseconds interval(1000000 / std::max(1, mixer_.fps));
+    auto next_tick = std::chrono::steady_clock::now();
+    time_t last_miss_log = 0;
     while(1) {
-        std::unique_lock<std::mutex> lck(exit_mutex_);
-        exit_cv_.wait_for(lck, std::chrono::milliseconds(40 - cost_ms));
-        if(exit_) {
-            break;
+        next_tick += interval;
+        {
+            std::unique_lock<std::mutex> lck(exit_mutex_);
+            exit_cv_.wait_until(lck, next_tick, [this]() { return exit_; });
+            if(exit_) {
+                break;
+            }
         }
 
         if((time(NULL) - last_packet_time_) > 5) 
@@ -680,58 +976,12 @@ void StreamMixer::mixFrame() {
             }
         }      
 
-        // auto begin = std::chrono::high_resolution_clock::now();
-        for(const auto & layer: mixer_.layers) {
-            int dst_width = layer.width;
-            int dst_height = layer.height;
-            int off_x = layer.off_x;
-            int off_y = layer.off_y;
-            std::string stream_id = layer.bridge_stream.id;
-            cv::Mat yuvImg;
-            auto it_mix_stream = mix_streams_.find(stream_id);
-            if(it_mix_stream == mix_streams_.end()) {
-                ELOG_ERROR("could not find stream:%s", stream_id.c_str());
-                continue;
-            }
-
-            std::shared_ptr<char> buff420;
-            int src_width;
-            int src_height;
-            std::tie(buff420, src_width, src_height) = it_mix_stream->second->getVideoData();
-            if(buff420) {
-                yuvImg.create(src_height*3/2, src_width, CV_8UC1);
-                //yuv转rgb
-                memcpy(yuvImg.data, buff420.get(), src_width*src_height*3/2);
-                cv::Mat rgbImg;
-                cv::cvtColor(yuvImg, rgbImg, cv::COLOR_YUV2RGB_I420);
-                //缩放
-                cv::Mat scaleImage;
-                resize(rgbImg, scaleImage, cv::Size(dst_width, dst_height), 0, 0, cv::INTER_LINEAR);
-                //贴图
-                cv::Mat imageROI;
-                imageROI = dst_rgb_img(cv::Rect(off_x, off_y, scaleImage.cols, scaleImage.rows));
-                cv::Mat	matMask;
-                cv::cvtColor(scaleImage, matMask, cv::COLOR_BGR2GRAY);
-                scaleImage.copyTo(imageROI, matMask);
-            } else {
-                ELOG_ERROR("====================== could not get video data of %s =====================", layer.stream_id);
-            }
-        }
+        rtc::scoped_refptr<webrtc::I420Buffer> canvas = composeFrame();
 
-        cv::cvtColor(dst_rgb_img, dst_yuv_img, cv::COLOR_RGB2YUV_I420);
-        // auto end = std::chrono::high_resolution_clock::now();
-        // auto dur = std::chrono::duration_cast<std::chrono::milliseconds>(end-begin);
-        // cost_ms = dur.count();
-        // ELOG_ERROR("*************** cost_ms=%d ****************", cost_ms);
-        // auto begin1 = std::chrono::high_resolution_clock::now();
-        send_worker_thread_->Invoke<int>(RTC_FROM_HERE, [=, &dst_yuv_img]() {
+        send_worker_thread_->Invoke<int>(RTC_FROM_HERE, [=]() {
             webrtc::VideoFrame frame =
             webrtc::VideoFrame::Builder()
-            .set_video_frame_buffer(webrtc::I420Buffer::Copy(mixer_.width, 
-                                                             mixer_.height, 
-                                                             dst_yuv_img.data, mixer_.width, 
-                                                             dst_yuv_img.data+mixer_.width*mixer_.height, (mixer_.width+1)/2, 
-                                                             dst_yuv_img.data+mixer_.width*mixer_.height*5/4, (mixer_.width+1)/2))
+            .set_video_frame_buffer(canvas)
             .set_timestamp_us(rtc::SystemTimeMillis()*1000)
             .set_id(0)
             .build();
@@ -741,9 +991,25 @@ void StreamMixer::mixFrame() {
             }
             return 0;
         });
-        // auto end1 = std::chrono::high_resolution_clock::now();
-        // auto dur1 = std::chrono::duration_cast<std::chrono::milliseconds>(end1-begin1);
-        // ELOG_ERROR("*************** cost_ms1=%d ****************", dur1.count());
+        mixed_ticks_++;
+
+        // Ran past the next deadline: skip the ticks we missed instead of bursting to catch up
+        auto now = std::chrono::steady_clock::now();
+        if(now >= next_tick + interval) {
+            auto cost_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - next_tick).count();
+            uint64_t missed = 0;
+            while(next_tick + interval <= now) {
+                next_tick += interval;
+                missed++;
+            }
+            missed_ticks_ += missed;
+            if(time(NULL) - last_miss_log >= 5) {
+                last_miss_log = time(NULL);
+                ELOG_WARN("mixer:%s frame took %lld ms, missed %llu ticks, %llu of %llu ticks missed in total",
+                          mixer_.id.c_str(), (long long)cost_ms, (unsigned long long)missed,
+                          (unsigned long long)missed_ticks_.load(), (unsigned long long)(mixed_ticks_.load() + missed_ticks_.load()));
+            }
+        }
     }
 }
 
@@ -756,8 +1022,13 @@ void StreamMixer::close()
     if(video_mix_thread_) {
         video_mix_thread_->join();
     }
-    removeRecvStreams();
-    removeSendStream();
+    if(opus_mixer_) {
+        opus_mixer_->close();
+        opus_mixer_.reset();
+    } else {
+        removeRecvStreams();
+        removeSendStream();
+    }
 
     setFeedbackSink(nullptr);
     setAudioSink(nullptr);
@@ -778,38 +1049,39 @@ StreamMixer::~StreamMixer()
 int StreamMixer::deliverAudioData_(std::shared_ptr<DataPacket> data_packet, const std::string &stream_id)
 {
     last_packet_time_ = time(NULL);
-    auto it = mix_streams_.find(stream_id);
-    if(it == mix_streams_.end()) {
+    if(opus_mixer_) {
+        opus_mixer_->deliverAudioData(std::move(data_packet), stream_id);
         return 0;
     }
 
-    std::shared_ptr<MixStream> mix_stream = it->second;
-    recv_worker_thread_->Invoke<int>(RTC_FROM_HERE, [=]() {
-        mix_stream->DeliverPacket(webrtc::MediaType::AUDIO, data_packet);
+    std::shared_ptr<MixStream> mix_stream = findMixStream(stream_id);
+    if(!mix_stream) {
         return 0;
-    });
+    }
+
+    mix_stream->enqueuePacket(webrtc::MediaType::AUDIO, std::move(data_packet));
     return 0;
 }
 
 int StreamMixer::deliverVideoData_(std::shared_ptr<DataPacket> data_packet, const std::string &stream_id)
 {
     last_packet_time_ = time(NULL);
-    auto it = mix_streams_.find(stream_id);
-    if(it == mix_streams_.end()) {
+    std::shared_ptr<MixStream> mix_stream = findMixStream(stream_id);
+    if(!mix_stream) {
         return 0;
     }
 
-    std::shared_ptr<MixStream> mix_stream = it->second;
-    recv_worker_thread_->Invoke<int>(RTC_FROM_HERE, [=]() {
-        mix_stream->DeliverPacket(webrtc::MediaType::VIDEO, data_packet);
-        return 0;
-    });
+    mix_stream->enqueuePacket(webrtc::MediaType::VIDEO, std::move(data_packet));
     return 0;
 }
 
 int StreamMixer::deliverFeedback_(std::shared_ptr<DataPacket> fb_packet, const std::string &stream_id)
 {
     RtcpHeader *chead = reinterpret_cast<RtcpHeader*>(fb_packet->data);
+    if(!send_worker_thread_) {
+        // audio only mixers have no send call to feed
+        return fb_packet->length;
+    }
     send_worker_thread_->Invoke<int>(RTC_FROM_HERE, [=]() {
         rtc::CopyOnWriteBuffer buffer(fb_packet->data, fb_packet->length);
         //send_call_->Receiver()->DeliverPacket(webrtc::MediaType::ANY, buffer, fb_packet->received_time_ms*1000);
@@ -829,11 +1101,14 @@ bool StreamMixer::SendRtp(const uint8_t* packet,
     } 
     
     if(rtp_packet->PayloadType() == 111) {
-        std::shared_ptr<erizo::DataPacket> ez_packet = std::make_shared<erizo::DataPacket>(1, (const char*)packet, length, erizo::AUDIO_PACKET, ClockUtils::getCurrentMs());
+        std::shared_ptr<erizo::DataPacket> ez_packet = erizo::makeDataPacket(1, (const char*)packet, length, erizo::AUDIO_PACKET, ClockUtils::getCurrentMs());
         otm_processor_->deliverAudioData(std::move(ez_packet), mixer_.id);
         // ELOG_ERROR("mixer send audio");
     } else if(rtp_packet->PayloadType() == 101) {
-        std::shared_ptr<erizo::DataPacket> ez_packet = std::make_shared<erizo::DataPacket>(1, (const char*)packet, length, erizo::VIDEO_PACKET, ClockUtils::getCurrentMs());
+        std::shared_ptr<erizo::DataPacket> ez_packet = erizo::makeDataPacket(1, (const char*)packet, length, erizo::VIDEO_PACKET, ClockUtils::getCurrentMs());
+        if(!simulcast_ssrcs_.empty()) {
+            tagSimulcastLayer(ez_packet, *rtp_packet);
+        }
         otm_processor_->deliverVideoData(std::move(ez_packet), mixer_.id);
         ELOG_ERROR("mixer send video");
     } else {
@@ -842,14 +1117,40 @@ bool StreamMixer::SendRtp(const uint8_t* packet,
     return true;
 }
 
+void StreamMixer::tagSimulcastLayer(const std::shared_ptr<DataPacket> &ez_packet, const webrtc::RtpPacket &rtp_packet)
+{//和LayerDetectorHandler对H264 simulcast的标记一致，订阅端的QualityFilterHandler据此选层
+    auto it = std::find(simulcast_ssrcs_.begin(), simulcast_ssrcs_.end(), rtp_packet.Ssrc());
+    if(it == simulcast_ssrcs_.end()) {
+        return;
+    }
+    ez_packet->codec = "H264";
+    ez_packet->clock_rate = 90000;
+    ez_packet->compatible_spatial_layers = {static_cast<int>(it - simulcast_ssrcs_.begin())};
+    ez_packet->compatible_temporal_layers = {0};
+    ez_packet->ending_of_layer_frame = rtp_packet.Marker();
+    RTPPayloadH264 *payload = h264_parser_.parseH264((unsigned char*)rtp_packet.payload().data(), rtp_packet.payload_size());
+    ez_packet->is_keyframe = payload->frameType == kH264IFrame;
+    delete payload;
+}
+
+int StreamMixer::totalVideoBitrateBps() const
+{
+    int bitrate_kbps = mixer_.bitrate;
+    for(auto &rendition : mixer_.renditions) {
+        bitrate_kbps += rendition.bitrate;
+    }
+    return bitrate_kbps * 1000;
+}
+
 bool StreamMixer::SendRtcp(const uint8_t* packet, size_t length)
 {//这里的rtcp为sr包及sdes包，需要发送给所有的客户端
     RtcpHeader *chead = reinterpret_cast<RtcpHeader*> ((char*)packet);
-    if(chead->getSSRC() == mixer_.video_ssrc) {
-        std::shared_ptr<erizo::DataPacket> ez_packet = std::make_shared<erizo::DataPacket>(1, (const char*)packet, length, erizo::VIDEO_PACKET, ClockUtils::getCurrentMs());
+    if(chead->getSSRC() == mixer_.video_ssrc ||
+       std::find(simulcast_ssrcs_.begin(), simulcast_ssrcs_.end(), chead->getSSRC()) != simulcast_ssrcs_.end()) {
+        std::shared_ptr<erizo::DataPacket> ez_packet = erizo::makeDataPacket(1, (const char*)packet, length, erizo::VIDEO_PACKET, ClockUtils::getCurrentMs());
         otm_processor_->deliverVideoData(std::move(ez_packet), mixer_.id);
     } else if(chead->getSSRC() == mixer_.audio_ssrc) {
-        std::shared_ptr<erizo::DataPacket> ez_packet = std::make_shared<erizo::DataPacket>(1, (const char*)packet, length, erizo::AUDIO_PACKET, ClockUtils::getCurrentMs());
+        std::shared_ptr<erizo::DataPacket> ez_packet = erizo::makeDataPacket(1, (const char*)packet, length, erizo::AUDIO_PACKET, ClockUtils::getCurrentMs());
         otm_processor_->deliverAudioData(std::move(ez_packet), mixer_.id);
     } else {
         ELOG_ERROR("deliver unknown rtcp");
@@ -870,10 +1171,41 @@ std::vector<uint32_t> CustomBitrateAllocationStrategy::AllocateBitrates(uint32_t
         if(track_config.track_id == stream_mixer_->audio_track_id_) {
             vec_bitrates.push_back(65000);//audio
         } else if(track_config.track_id == stream_mixer_->video_track_id_) {
-            vec_bitrates.push_back(stream_mixer_->mixer_.bitrate*1000);
+            vec_bitrates.push_back(stream_mixer_->totalVideoBitrateBps());
         }
     }
     return vec_bitrates;
 }
 
+RenditionStreamFactory::RenditionStreamFactory(const Mixer &mixer)
+{
+    mixer_ = mixer;
+}
+
+std::vector<webrtc::VideoStream> RenditionStreamFactory::CreateEncoderStreams(int width, int height,
+                                                                              const webrtc::VideoEncoderConfig &encoder_config)
+{
+    std::vector<webrtc::VideoStream> streams;
+    auto add_stream = [&](int stream_width, int stream_height, uint32_t bitrate_kbps) {
+        webrtc::VideoStream stream;
+        // sizes are relative to the canvas, follow it if the encoder input is adapted
+        stream.width = std::max(2, (int)((int64_t)stream_width * width / std::max(1, mixer_.width)) & ~1);
+        stream.height = std::max(2, (int)((int64_t)stream_height * height / std::max(1, mixer_.height)) & ~1);
+        stream.max_framerate = mixer_.fps;
+        stream.max_bitrate_bps = bitrate_kbps * 1000;
+        stream.target_bitrate_bps = stream.max_bitrate_bps;
+        stream.min_bitrate_bps = std::min(30000, stream.max_bitrate_bps);
+        stream.max_qp = 56;
+        stream.num_temporal_layers = 1;
+        stream.active = true;
+        streams.push_back(stream);
+    };
+    for(auto &rendition : mixer_.renditions) {
+        add_stream(rendition.width, rendition.height, rendition.bitrate);
+    }
+    add_stream(mixer_.width, mixer_.height, mixer_.bitrate);
+    streams.resize(std::min(streams.size(), encoder_config.number_of_streams));
+    return streams;
+}
+
 } // namespace erizo
\ No newline at end of file
@@ -4,7 +4,9 @@
 */
 #ifndef ERIZO_SRC_ERIZO_MEDIA_MIXERS_StreamMixer_H_
 #define ERIZO_SRC_ERIZO_MEDIA_MIXERS_StreamMixer_H_
+#include <atomic>
 #include <map>
+#include <memory>
 #include <vector>
 #include <tuple>
 #include <condition_variable>
@@ -23,12 +25,19 @@
 #include "api/call/call_factory_interface.h"
 #include "test/fake_videorenderer.h"
 #include "api/scoped_refptr.h"
+#include "api/video/i420_buffer.h"
+#include "common_video/include/i420_buffer_pool.h"
 #include "video_render.h"
 #include "media/base/video_source_base.h"
 #include "MediaStream.h"
 #include "media/mixers/mixer.h"
 #include "api/video_codecs/video_decoder_factory.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/async_invoker.h"
+#include "lib/MpscRing.h"
+#include "modules/rtp_rtcp/source/rtp_packet.h"
+#include "rtp/RtpH264Parser.h"
+#include "media/mixers/OpusMixer.h"
 
 namespace erizo
 {
@@ -62,20 +71,45 @@ private:
 	std::ofstream file_;
 };
 
+// Latest frame decoded by a MixStream, shared read-only with the mixer thread
+struct DecodedFrame
+{
+    rtc::scoped_refptr<webrtc::I420BufferInterface> buffer;
+    uint64_t sequence = 0;
+};
+
+// What the layers of one StreamMixer share, all owned by the StreamMixer
+struct MixStreamContext
+{
+    webrtc::Call *call = nullptr;
+    rtc::scoped_refptr<webrtc::AudioDecoderFactory> audio_decoder_factory;
+    webrtc::VideoDecoderFactory *video_decoder_factory = nullptr;
+    // the thread call is used on
+    rtc::Thread *worker_thread = nullptr;
+};
+
 class MixStream : public rtc::VideoSinkInterface<webrtc::VideoFrame>, public webrtc::Transport
 { //单独一路带混合的流
     DECLARE_LOGGER();
 
 public:
     MixStream(const Layer &layer,
-              cricket::MediaEngineInterface *media_engine);
+              const MixStreamContext &context);
     virtual ~MixStream();
     bool init();
     void close();
     void OnFrame(const webrtc::VideoFrame &frame);
-    std::tuple<std::shared_ptr<char>, int, int> getVideoData();
+    // nullptr until the first frame is decoded
+    std::shared_ptr<const DecodedFrame> getLatestFrame();
+    // Worker thread only
     int DeliverPacket(webrtc::MediaType media_type,
                       std::shared_ptr<DataPacket> data_packet);
+    // Any thread, never blocks: the packet is queued for the worker thread, or dropped when the
+    // queue is full because the decoder does not keep up
+    bool enqueuePacket(webrtc::MediaType media_type,
+                       std::shared_ptr<DataPacket> data_packet);
+    uint64_t getDeliveredPackets() const { return delivered_packets_; }
+    uint64_t getDroppedPackets() const { return dropped_packets_; }
 
 public:
     //transport interface
@@ -85,20 +119,35 @@ public:
     virtual bool SendRtcp(const uint8_t *packet, size_t length);
 
 private:
-    std::unique_ptr<webrtc::RtcEventLog> rtc_event_log_ = nullptr;
-    std::unique_ptr<webrtc::Call> call_ = nullptr;
+    MixStreamContext context_;
+    // the mixer's receive Call, nullptr once closed
+    webrtc::Call *call_ = nullptr;
     webrtc::VideoReceiveStream *video_recv_stream_ = nullptr;
     webrtc::AudioReceiveStream *audio_recv_stream_ = nullptr;
-    rtc::scoped_refptr<webrtc::AudioDecoderFactory> audio_decoder_factory_ = nullptr;
-    std::unique_ptr<webrtc::VideoDecoderFactory> video_decoder_factory_ = nullptr;
     Layer layer_;
-    std::mutex buf_mutex_;
-    std::shared_ptr<char> yuv420_buf_ = nullptr;
-    int width_ = 0;
-    int height_ = 0;
-    cricket::MediaEngineInterface *media_engine_;
+    // written by the decoder thread, read by the mixer thread with std::atomic_load
+    std::shared_ptr<const DecodedFrame> latest_frame_;
     uint64_t frame_count_ = 0;
     bool initialized_ = false;
+
+    struct IngressPacket
+    {
+        webrtc::MediaType media_type = webrtc::MediaType::ANY;
+        std::shared_ptr<DataPacket> packet;
+    };
+    static constexpr size_t kIngressQueueSize = 1024;
+    // packets delivered per task, so one busy stream does not hold the worker thread
+    static constexpr int kIngressBatch = 64;
+    void scheduleDrain();
+    void drainIngress();
+    rtc::Thread *worker_thread_;
+    MpscRing<IngressPacket> ingress_;
+    std::atomic<bool> closed_;
+    std::atomic<bool> drain_scheduled_;
+    std::atomic<uint64_t> delivered_packets_;
+    std::atomic<uint64_t> dropped_packets_;
+    // last member: pending drains are cancelled or waited for before the queue goes away
+    rtc::AsyncInvoker invoker_;
     friend class StreamMixer;
 };
 
@@ -117,6 +166,22 @@ private:
     StreamMixer *stream_mixer_;
 };
 
+/*
+ * Hands the encoder exactly the configured simulcast ladder: the renditions from lowest to
+ * highest, then the full canvas. EncoderStreamFactory would derive its own sizes and bitrates
+ * from the input resolution instead.
+ */
+class RenditionStreamFactory : public webrtc::VideoEncoderConfig::VideoStreamFactoryInterface
+{
+public:
+    RenditionStreamFactory(const Mixer &mixer);
+    std::vector<webrtc::VideoStream> CreateEncoderStreams(int width, int height,
+                                                          const webrtc::VideoEncoderConfig &encoder_config) override;
+
+private:
+    Mixer mixer_;
+};
+
 class StreamMixer : public MediaSink, public MediaSource, public FeedbackSink, public FeedbackSource, public rtc::VideoSourceBase, public webrtc::Transport, public std::enable_shared_from_this<StreamMixer>
 {
     DECLARE_LOGGER();
@@ -154,6 +219,12 @@ public:
     void mixFrame();
     virtual void close() override;
 
+    // Mixing ticks that ran and ticks skipped because compositing overran its deadline
+    uint64_t getMixedTicks() const { return mixed_ticks_; }
+    uint64_t getMissedTicks() const { return missed_ticks_; }
+    // Incoming packets dropped because a MixStream ingress queue was full, over all streams
+    uint64_t getDroppedPackets() const;
+
     /**
     * Sets the Event Listener for this StreamMixer
     */
@@ -164,10 +235,18 @@ private:
     virtual int deliverFeedback_(std::shared_ptr<DataPacket> data_packet, const std::string &stream_id) override;
     virtual int deliverEvent_(MediaEventPtr event) override { return 0; }
     virtual int sendPLI() override { return 0; }
+    rtc::scoped_refptr<webrtc::I420Buffer> composeFrame();
+    std::shared_ptr<MixStream> findMixStream(const std::string &stream_id) const;
+    MixStreamContext mixStreamContext();
+    // recv_worker_thread_ only
+    void addMixStream(const std::string &stream_id, std::shared_ptr<MixStream> mix_stream);
+    void removeMixStream(const std::string &stream_id);
     int createSendStream();
     int createRecvStreams();
     int removeRecvStreams();
     int removeSendStream();
+    void tagSimulcastLayer(const std::shared_ptr<DataPacket> &ez_packet, const webrtc::RtpPacket &rtp_packet);
+    int totalVideoBitrateBps() const;
     std::vector<webrtc::RtpExtension> GetVideoRtpExtensions();
     webrtc::VideoCodecH264 GetDefaultH264Settings();
 
@@ -180,22 +259,30 @@ public:
 
 private:
     Mixer mixer_;
+    // send ssrcs from the lowest rendition to the full canvas, the position is the spatial layer
+    std::vector<uint32_t> simulcast_ssrcs_;
+    // set when mixer.audio_only, replaces the send and receive calls
+    std::unique_ptr<OpusMixer> opus_mixer_;
+    RtpH264Parser h264_parser_;
     std::unique_ptr<webrtc::RtcEventLog> rtc_event_log_;
     std::unique_ptr<webrtc::VideoEncoderFactory> video_encoder_factory_ = nullptr;
     rtc::scoped_refptr<webrtc::AudioEncoderFactory> audio_encoder_factory_ = nullptr;
     std::unique_ptr<webrtc::VideoBitrateAllocatorFactory> bitrate_allocator_factory_ = nullptr;
 
-    // rtc::scoped_refptr<webrtc::AudioDecoderFactory> audio_decoder_factory_;
-    // std::unique_ptr<webrtc::VideoDecoderFactory> video_decoder_factory_;
-
     std::unique_ptr<cricket::MediaEngineInterface> recv_media_engine_;
     rtc::scoped_refptr<webrtc::AudioDeviceModule> recv_adm_;
     // rtc::scoped_refptr<webrtc::AudioMixer> recv_audio_mixer_;
-    std::unique_ptr<rtc::Thread> recv_worker_thread_;
+    // shared by every MixStream of this mixer
+    std::unique_ptr<webrtc::RtcEventLog> recv_event_log_;
+    std::unique_ptr<webrtc::Call> recv_call_;
+    rtc::scoped_refptr<webrtc::AudioDecoderFactory> audio_decoder_factory_;
+    std::unique_ptr<webrtc::VideoDecoderFactory> video_decoder_factory_;
+    // both borrowed from MixerThreadPool
+    rtc::Thread *recv_worker_thread_ = nullptr;
 
     std::atomic<bool> mix_start_;
     rtc::scoped_refptr<webrtc::AudioDeviceModule> send_adm_;
-    std::unique_ptr<rtc::Thread> send_worker_thread_;
+    rtc::Thread *send_worker_thread_ = nullptr;
     std::shared_ptr<std::thread> video_mix_thread_;
     std::unique_ptr<webrtc::Call> send_call_ = nullptr;
     webrtc::VideoSendStream *video_send_stream_ = nullptr;
@@ -211,7 +298,45 @@ private:
     std::condition_variable exit_cv_;
     uint32_t last_packet_time_ = 0; // 上个包的时间：如果没有流超过一定时间，通知外部关闭mixer
     
-    std::map<std::string, std::shared_ptr<MixStream>> mix_streams_;
+    // Publishes mixer_.layers for the mixer thread, after every change to it
+    void publishLayers();
+
+    typedef std::map<std::string, std::shared_ptr<MixStream>> MixStreamMap;
+    // Copy-on-write: replaced on recv_worker_thread_, read with std::atomic_load by delivery
+    // threads and the mixer thread
+    std::shared_ptr<const MixStreamMap> mix_streams_;
+    typedef std::vector<Layer> LayerList;
+    // Immutable copy of mixer_.layers, in paint order. mixer_.layers is changed on
+    // recv_worker_thread_, the mixer thread only reads this with std::atomic_load.
+    std::shared_ptr<const LayerList> layers_;
+    webrtc::I420BufferPool frame_pool_;
+    // Where a layer is painted and from which decoded frame
+    struct CanvasLayer
+    {
+        std::shared_ptr<const DecodedFrame> source;
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+        int alpha = 255;
+        bool operator==(const CanvasLayer &other) const;
+    };
+    // Last scaled output of a layer, valid while its source frame and size stay the same
+    struct ScaledLayer
+    {
+        std::shared_ptr<const DecodedFrame> source;
+        int width = 0;
+        int height = 0;
+        rtc::scoped_refptr<webrtc::I420Buffer> scaled;
+    };
+    // bridge stream id and index of a layer, which stay the same when other layers come and go
+    typedef std::pair<std::string, int> LayerKey;
+    // one per layer, so layers painted in parallel never share one. Mixer thread only.
+    std::map<LayerKey, ScaledLayer> scaled_cache_;
+    std::vector<CanvasLayer> last_layout_;
+    rtc::scoped_refptr<webrtc::I420Buffer> last_canvas_;
+    std::atomic<uint64_t> mixed_ticks_{0};
+    std::atomic<uint64_t> missed_ticks_{0};
     MediaStreamEventListener* media_stream_event_listener_ = nullptr;
 
     std::shared_ptr<MixerLog> mixer_log_;
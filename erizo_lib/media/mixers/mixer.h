@@ -309,6 +309,7 @@
 
 #ifndef MIXER_H_
 #define MIXER_H_
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -325,6 +326,8 @@ public:
     int off_x;
     int off_y;
     double audio_gain = 1.0f;//音频增益，1是默认值,0则静音
+    int alpha = 255;//视频不透明度，0-255，255为不透明
+    std::string client_id;//发布此流的client_id，纯音频混流时用于给该client输出去掉自己声音的混音
     uint32_t video_ssrc;
     uint32_t audio_ssrc;
     BridgeStream bridge_stream;
@@ -346,6 +349,8 @@ public:
         root["height"] = height;
         root["offset_x"] = off_x;
         root["offset_y"] = off_y;
+        root["alpha"] = alpha;
+        root["client_id"] = client_id;
         // root["audio_gain"] = audio_gain;
         root["video_ssrc"] = video_ssrc;
         root["audio_ssrc"] = audio_ssrc;
@@ -363,6 +368,8 @@ public:
         root["height"] = height;
         root["offset_x"] = off_x;
         root["offset_y"] = off_y;
+        root["alpha"] = alpha;
+        root["client_id"] = client_id;
         root["audio_gain"] = audio_gain;
         root["video_ssrc"] = video_ssrc;
         root["audio_ssrc"] = audio_ssrc;
@@ -408,6 +415,14 @@ public:
         if(root.isMember("audio_gain") && root["audio_gain"].isDouble()) {
             layer.audio_gain = root["audio_gain"].asDouble();
         }
+
+        if(root.isMember("alpha") && root["alpha"].isInt()) {
+            layer.alpha = std::max(0, std::min(255, root["alpha"].asInt()));
+        }
+
+        if(root.isMember("client_id") && root["client_id"].isString()) {
+            layer.client_id = root["client_id"].asString();
+        }
         return 0;
     }
 
@@ -445,6 +460,50 @@ public:
             layer.audio_gain = root["audio_gain"].asDouble();
         }
 
+        if(root.isMember("alpha") && root["alpha"].isInt()) {
+            layer.alpha = std::max(0, std::min(255, root["alpha"].asInt()));
+        }
+
+        if(root.isMember("client_id") && root["client_id"].isString()) {
+            layer.client_id = root["client_id"].asString();
+        }
+
+        return 0;
+    }
+};
+
+// 混流的一路低分辨率输出，作为simulcast的一层与主输出一起编码
+struct Rendition {
+public:
+    int width;
+    int height;
+    uint32_t bitrate;//kbps
+    uint32_t video_ssrc;
+
+    const Json::Value toJsonValue() const
+    {
+        Json::Value root;
+        root["width"] = width;
+        root["height"] = height;
+        root["bitrate"] = bitrate;
+        root["video_ssrc"] = video_ssrc;
+        return root;
+    }
+
+    static int fromJSON(const Json::Value &root, Rendition &rendition)
+    {
+        RETURN_IF_CHECK_MEM_ERR(root, "width", Int, -1);
+        RETURN_IF_CHECK_MEM_ERR(root, "height", Int, -2);
+        RETURN_IF_CHECK_MEM_ERR(root, "bitrate", UInt, -3);
+        RETURN_IF_CHECK_MEM_ERR(root, "video_ssrc", UInt, -4);
+
+        rendition.width = root["width"].asInt();
+        rendition.height = root["height"].asInt();
+        rendition.bitrate = root["bitrate"].asUInt();
+        rendition.video_ssrc = root["video_ssrc"].asUInt();
+        if(rendition.width <= 0 || rendition.height <= 0 || rendition.bitrate == 0) {
+            return -5;
+        }
         return 0;
     }
 };
@@ -468,7 +527,10 @@ public:
     uint32_t bitrate;//控制码率
     int width;//输出宽度
     int height;//输出高度
+    int fps = 25;//输出帧率
+    bool audio_only = false;//纯音频混流，不解码不合成视频
     std::vector<Layer> layers;
+    std::vector<Rendition> renditions;//额外的低分辨率输出，按分辨率从低到高排列
 
     std::string toJSON() const
     {
@@ -495,6 +557,13 @@ public:
             j_layers.append(l.toJsonValue());
         }
         root["layers"] = j_layers;
+        root["fps"] = fps;
+        root["audio_only"] = audio_only;
+        Json::Value j_renditions(Json::arrayValue);
+        for (auto r : renditions) {
+            j_renditions.append(r.toJsonValue());
+        }
+        root["renditions"] = j_renditions;
         Json::FastWriter writer;
         return writer.write(root);
     }
@@ -524,6 +593,13 @@ public:
             j_layers.append(l.toJsonValue());
         }
         root["layers"] = j_layers;
+        root["fps"] = fps;
+        root["audio_only"] = audio_only;
+        Json::Value j_renditions(Json::arrayValue);
+        for (auto r : renditions) {
+            j_renditions.append(r.toJsonValue());
+        }
+        root["renditions"] = j_renditions;
         return root;
     }
 
@@ -581,6 +657,30 @@ public:
             }
             mixer.layers.emplace_back(std::move(l));
         }
+
+        if(root.isMember("fps") && root["fps"].isInt()) {
+            mixer.fps = std::max(1, std::min(60, root["fps"].asInt()));
+        }
+
+        if(root.isMember("audio_only") && root["audio_only"].isBool()) {
+            mixer.audio_only = root["audio_only"].asBool();
+        }
+
+        if(root.isMember("renditions") && root["renditions"].isArray()) {
+            Json::Value renditions = root["renditions"];
+            for(int i = 0; i < renditions.size(); i++) {
+                Rendition r;
+                int ret = Rendition::fromJSON(renditions[i], r);
+                if(0 != ret) {
+                    printf("parse rendition failed.\n");
+                    return ret - 30;
+                }
+                mixer.renditions.emplace_back(std::move(r));
+            }
+            std::stable_sort(mixer.renditions.begin(), mixer.renditions.end(), [](const Rendition &a, const Rendition &b) {
+                return a.width * a.height < b.width * b.height;
+            });
+        }
         return 0;
     }
 
@@ -634,6 +734,30 @@ public:
             mixer.layers.emplace_back(std::move(l));
         }
 
+        if(root.isMember("fps") && root["fps"].isInt()) {
+            mixer.fps = std::max(1, std::min(60, root["fps"].asInt()));
+        }
+
+        if(root.isMember("audio_only") && root["audio_only"].isBool()) {
+            mixer.audio_only = root["audio_only"].asBool();
+        }
+
+        if(root.isMember("renditions") && root["renditions"].isArray()) {
+            Json::Value renditions = root["renditions"];
+            for(int i = 0; i < renditions.size(); i++) {
+                Rendition r;
+                int ret = Rendition::fromJSON(renditions[i], r);
+                if(0 != ret) {
+                    printf("parse rendition failed.\n");
+                    return ret - 30;
+                }
+                mixer.renditions.emplace_back(std::move(r));
+            }
+            std::stable_sort(mixer.renditions.begin(), mixer.renditions.end(), [](const Rendition &a, const Rendition &b) {
+                return a.width * a.height < b.width * b.height;
+            });
+        }
+
         return 0;
     }
 };
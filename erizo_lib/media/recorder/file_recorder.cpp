@@ -1,4 +1,9 @@
 #include "file_recorder.h"
+#include "media/Depacketizer.h"
+
+int FileRecorder::WriteH264Frame(const erizo::H264Frame &frame, int64_t pts) {
+    return WriteH264Data(frame.data, frame.size, pts);
+}
 
 void FileRecorder::onCreateFile(const std::function<void(const std::string &file, int64_t timestamp)> &create_file_cb) {
     create_file_cb_ = std::make_shared<std::function<void(const std::string &file, int64_t timestamp)>>(create_file_cb);
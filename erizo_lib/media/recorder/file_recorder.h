@@ -5,6 +5,10 @@
 #include <memory>
 #include <math.h>
 
+namespace erizo {
+struct H264Frame;
+}
+
 class FileRecorder {
 public:
     FileRecorder(){};
@@ -15,6 +19,8 @@ public:
     virtual int SetESConfig(const uint8_t *config, size_t len) = 0;
     virtual int CreateFile(const std::string &file) = 0;
     virtual int WriteH264Data(const uint8_t *nalu_data, size_t len, int64_t pts) = 0;
+    //frame已由H264Depacketizer标注好nalu，所有recorder共用同一帧，不要再扫描起始码；默认按WriteH264Data写入
+    virtual int WriteH264Frame(const erizo::H264Frame &frame, int64_t pts);
     virtual int WriteAACData(const uint8_t *nalu_data, size_t len, int64_t pts) = 0;
     virtual int CloseFile() = 0;
 
@@ -1,4 +1,5 @@
 #include "hls_recorder.h"
+#include "media/Depacketizer.h"
 #include "lib/Clock.h"
 #include "lib/ClockUtils.h"
 DEFINE_LOGGER(HlsRecorder, "media.HlsRecorder");
@@ -168,6 +169,15 @@ int HlsRecorder::CreateFile(const std::string &file) {
 }
 
 int HlsRecorder::WriteH264Data(const uint8_t *data, size_t len, int64_t pts) {
+    return writeVideo(data, len, pts, (data[4]&0x1f) == 5);
+}
+
+int HlsRecorder::WriteH264Frame(const erizo::H264Frame &frame, int64_t pts) {
+    //sps,pps与idr在同一帧时也要标记为关键帧
+    return writeVideo(frame.data, frame.size, pts, frame.keyframe);
+}
+
+int HlsRecorder::writeVideo(const uint8_t *data, size_t len, int64_t pts, bool keyframe) {
     if(!initialized_) {
         return -1;
     }
@@ -183,7 +193,7 @@ int HlsRecorder::WriteH264Data(const uint8_t *data, size_t len, int64_t pts) {
     video_pkt.dts = pts;
     last_pts_ = pts;
     video_pkt.stream_index = 0;
-    if((data[4]&0x1f) == 5) {
+    if(keyframe) {
         video_pkt.flags |= AV_PKT_FLAG_KEY;
     }
     av_interleaved_write_frame(context_, &video_pkt);   // takes ownership of the packet
@@ -41,10 +41,12 @@ public:
     int SetESConfig(const uint8_t *config, size_t len);
     int CreateFile(const std::string &file);
     int WriteH264Data(const uint8_t *data, size_t len, int64_t pts);
+    int WriteH264Frame(const erizo::H264Frame &frame, int64_t pts);
     int WriteAACData(const uint8_t *data, size_t len, int64_t pts);
     int CloseFile();
 private:
     int addAdtsHeader(const uint8_t *data, size_t len, uint8_t *data_new);
+    int writeVideo(const uint8_t *data, size_t len, int64_t pts, bool keyframe);
     int initContext();
     std::string file_name_;
     uint8_t sps_[128];
@@ -1,5 +1,6 @@
 #include <netinet/in.h>
 #include "mp4_recorder.h"
+#include "media/Depacketizer.h"
 #include "lib/Clock.h"
 #include "lib/ClockUtils.h"
 DEFINE_LOGGER(MP4Recorder, "media.MP4Recorder");
@@ -148,11 +149,7 @@ void MP4Recorder::ReadNaluFromBuf(uint8_t *buf, size_t len, std::vector<NaluUnit
   }
 }
 
-int MP4Recorder::WriteH264Data(const uint8_t *data, size_t len, int64_t pts) {
-    if(!initialized_) {
-        return -1;
-    }
-
+int64_t MP4Recorder::nextDuration(int64_t pts) {
     int64_t duration;
     if(last_pts_ == 0) {
         duration = 0;
@@ -160,34 +157,64 @@ int MP4Recorder::WriteH264Data(const uint8_t *data, size_t len, int64_t pts) {
         duration = pts - last_pts_;        
     }
     last_pts_ = pts;
+    return duration;
+}
+
+void MP4Recorder::writeNalu(int type, const uint8_t *data, size_t size, int64_t duration) {
+    if(type == 7) {
+        if(size > sizeof(sps_)) {
+            return;
+        }
+        memcpy(sps_, data, size);
+        sps_len_ = size;
+    } else if(type == 8) {
+        if(size > sizeof(pps_)) {
+            return;
+        }
+        memcpy(pps_, data, size);
+        pps_len_ = size;
+    } else if(type == 5) {//i-frame
+        uint32_t* p = (uint32_t*)video_buf_; 
+        memcpy(video_buf_+4, sps_, sps_len_);
+        memcpy(video_buf_+4+sps_len_, pps_, pps_len_);
+        memcpy(video_buf_+4+sps_len_+pps_len_, data, size);
+
+        int new_len = size+4+sps_len_+pps_len_;
+        *p = htonl(new_len-4);
+
+        MP4WriteSample(mp4_file_, video_track_, video_buf_, new_len, duration, 0, 1);
+    } else if(type == 1) {//p-frame
+        uint32_t* p = (uint32_t*)video_buf_; 
+        memcpy(p+1, data, size);
+        int new_len = size+4;
+        *p = htonl(size);
+        MP4WriteSample(mp4_file_, video_track_, video_buf_, new_len, duration, 0, 0);
+    }
+}
+
+int MP4Recorder::WriteH264Data(const uint8_t *data, size_t len, int64_t pts) {
+    if(!initialized_) {
+        return -1;
+    }
 
+    int64_t duration = nextDuration(pts);
     std::vector<NaluUnit> nalus;
     ReadNaluFromBuf((uint8_t*)data, len, nalus);
     for(size_t i = 0; i < nalus.size(); i++) {
-        if(nalus[i].type == 7) {
-            memcpy(sps_, nalus[i].data, nalus[i].size);
-            sps_len_ = nalus[i].size;
-        } else if(nalus[i].type == 8) {
-            memcpy(pps_, nalus[i].data, nalus[i].size);
-            pps_len_ = nalus[i].size;
-        } else if(nalus[i].type == 5) {//i-frame
-            uint32_t* p = (uint32_t*)video_buf_; 
-            memcpy(video_buf_+4, sps_, sps_len_);
-            memcpy(video_buf_+4+sps_len_, pps_, pps_len_);
-            memcpy(video_buf_+4+sps_len_+pps_len_, nalus[i].data, nalus[i].size);
-
-            int new_len = nalus[i].size+4+sps_len_+pps_len_;
-            *p = htonl(new_len-4);
-
-            MP4WriteSample(mp4_file_, video_track_, video_buf_, new_len, duration, 0, 1);
-        } else if(nalus[i].type == 1) {//p-frame
-            uint32_t* p = (uint32_t*)video_buf_; 
-            memcpy(p+1, nalus[i].data, nalus[i].size);
-            int new_len = nalus[i].size+4;
-            *p = htonl(nalus[i].size);
-            MP4WriteSample(mp4_file_, video_track_, video_buf_, new_len, duration, 0, 0);
-        }
-        
+        writeNalu(nalus[i].type, nalus[i].data, nalus[i].size, duration);
+    }
+    return 0;
+}
+
+int MP4Recorder::WriteH264Frame(const erizo::H264Frame &frame, int64_t pts) {
+    if(!initialized_) {
+        return -1;
+    }
+
+    //nalu边界在解包时已经确定，直接按偏移写入
+    int64_t duration = nextDuration(pts);
+    for(const auto &nal_unit : frame.nal_units) {
+        writeNalu(nal_unit.type, frame.data + nal_unit.offset, nal_unit.size, duration);
     }
     return 0;
 }
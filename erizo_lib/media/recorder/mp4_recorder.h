@@ -33,11 +33,14 @@ public:
     int SetESConfig(const uint8_t *config, size_t len);
     int CreateFile(const std::string &file);
     int WriteH264Data(const uint8_t *nalu_data, size_t len, int64_t pts);
+    int WriteH264Frame(const erizo::H264Frame &frame, int64_t pts);
     int WriteAACData(const uint8_t *data, size_t len, int64_t pts);
     int CloseFile();
 private:
     int initContext();
     void ReadNaluFromBuf(uint8_t *buf, size_t len, std::vector<NaluUnit> &nalus);
+    int64_t nextDuration(int64_t pts);
+    void writeNalu(int type, const uint8_t *data, size_t size, int64_t duration);
 
     MP4FileHandle mp4_file_;
     MP4TrackId video_track_;
@@ -10,7 +10,11 @@
 #ifndef ERIZO_SRC_ERIZO_PIPELINE_HANDLERCONTEXT_INL_H_
 #define ERIZO_SRC_ERIZO_PIPELINE_HANDLERCONTEXT_INL_H_
 
+#include <memory>
+#include <string>
+
 #include "./MediaDefinitions.h"
+#include "lib/LatencyHistogram.h"
 
 namespace erizo
 {
@@ -46,6 +50,12 @@ public:
     virtual void setNextOut(PipelineContext *ctx) = 0;
 
     virtual HandlerDir getDirection() = 0;
+
+    // Time each handler spends on a packet before passing it on (or dropping it)
+    virtual void enableLatencyStats() = 0;
+    // nullptr when disabled or when the handler has no such direction
+    virtual const LatencyHistogram *getReadLatency() = 0;
+    virtual const LatencyHistogram *getWriteLatency() = 0;
 };
 
 class InboundLink
@@ -161,7 +171,57 @@ public:
         return H::dir;
     }
 
+    void enableLatencyStats() override
+    {
+        if (H::dir != HandlerDir::OUT && !readLatency_)
+            readLatency_.reset(new LatencyHistogram());
+        if (H::dir != HandlerDir::IN && !writeLatency_)
+            writeLatency_.reset(new LatencyHistogram());
+    }
+
+    const LatencyHistogram *getReadLatency() override
+    {
+        return readLatency_.get();
+    }
+
+    const LatencyHistogram *getWriteLatency() override
+    {
+        return writeLatency_.get();
+    }
+
 protected:
+    // A handler's time runs from entering read()/write() until it fires the packet on or returns,
+    // so downstream handlers are not counted twice
+    void beginRead()
+    {
+        if (readLatency_)
+            readStart_ = LatencyHistogram::now();
+    }
+
+    void endRead()
+    {
+        if (readStart_ != 0)
+        {
+            readLatency_->record(LatencyHistogram::now() - readStart_);
+            readStart_ = 0;
+        }
+    }
+
+    void beginWrite()
+    {
+        if (writeLatency_)
+            writeStart_ = LatencyHistogram::now();
+    }
+
+    void endWrite()
+    {
+        if (writeStart_ != 0)
+        {
+            writeLatency_->record(LatencyHistogram::now() - writeStart_);
+            writeStart_ = 0;
+        }
+    }
+
     Context *impl_;
     std::weak_ptr<PipelineBase> pipelineWeak_;
     PipelineBase *pipelineRaw_;
@@ -171,6 +231,10 @@ protected:
 
 private:
     bool attached_{false};
+    std::unique_ptr<LatencyHistogram> readLatency_;
+    std::unique_ptr<LatencyHistogram> writeLatency_;
+    int64_t readStart_{0};
+    int64_t writeStart_{0};
 };
 
 template <class H>
@@ -203,6 +267,7 @@ public:
     void fireRead(std::shared_ptr<DataPacket> packet) override
     {
         auto guard = this->pipelineWeak_.lock();
+        this->endRead();
         if (this->nextIn_)
         {
             this->nextIn_->read(std::move(packet));
@@ -239,6 +304,7 @@ public:
     void fireWrite(std::shared_ptr<DataPacket> packet) override
     {
         auto guard = this->pipelineWeak_.lock();
+        this->endWrite();
         if (this->nextOut_)
         {
             this->nextOut_->write(std::move(packet));
@@ -268,7 +334,9 @@ public:
     void read(std::shared_ptr<DataPacket> packet) override
     {
         auto guard = this->pipelineWeak_.lock();
+        this->beginRead();
         this->handler_->read(this, std::move(packet));
+        this->endRead();
     }
 
     void readEOF() override
@@ -293,7 +361,9 @@ public:
     void write(std::shared_ptr<DataPacket> packet) override
     {
         auto guard = this->pipelineWeak_.lock();
+        this->beginWrite();
         this->handler_->write(this, std::move(packet));
+        this->endWrite();
     }
 
     void close() override
@@ -332,6 +402,7 @@ public:
     void fireRead(std::shared_ptr<DataPacket> packet) override
     {
         auto guard = this->pipelineWeak_.lock();
+        this->endRead();
         if (this->nextIn_)
         {
             this->nextIn_->read(std::move(packet));
@@ -379,7 +450,9 @@ public:
     void read(std::shared_ptr<DataPacket> packet) override
     {
         auto guard = this->pipelineWeak_.lock();
+        this->beginRead();
         this->handler_->read(this, std::move(packet));
+        this->endRead();
     }
 
     void readEOF() override
@@ -430,6 +503,7 @@ public:
     void fireWrite(std::shared_ptr<DataPacket> packet) override
     {
         auto guard = this->pipelineWeak_.lock();
+        this->endWrite();
         if (this->nextOut_)
         {
             return this->nextOut_->write(std::move(packet));
@@ -459,7 +533,9 @@ public:
     void write(std::shared_ptr<DataPacket> packet) override
     {
         auto guard = this->pipelineWeak_.lock();
-        return this->handler_->write(this, std::move(packet));
+        this->beginWrite();
+        this->handler_->write(this, std::move(packet));
+        this->endWrite();
     }
 
     void close() override
@@ -205,4 +205,21 @@ void Pipeline::disable(std::string name)
     }
 }
 
+void Pipeline::enableLatencyStats()
+{
+    for (auto &ctx : ctxs_)
+    {
+        ctx->enableLatencyStats();
+    }
+}
+
+void Pipeline::forEachLatencyStats(
+    std::function<void(const std::string &, const LatencyHistogram *, const LatencyHistogram *)> f)
+{
+    for (auto &ctx : ctxs_)
+    {
+        f(ctx->getName(), ctx->getReadLatency(), ctx->getWriteLatency());
+    }
+}
+
 } // namespace erizo
@@ -10,6 +10,7 @@
 #ifndef ERIZO_SRC_ERIZO_PIPELINE_PIPELINE_H_
 #define ERIZO_SRC_ERIZO_PIPELINE_PIPELINE_H_
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -188,6 +189,12 @@ public:
     void enable(std::string name);
     void disable(std::string name);
 
+    // Must be called from the thread that drives the pipeline
+    void enableLatencyStats();
+    // Visits every handler with its read and write latency histograms, either may be nullptr
+    void forEachLatencyStats(
+        std::function<void(const std::string &, const LatencyHistogram *, const LatencyHistogram *)> f);
+
 protected:
     Pipeline();
 
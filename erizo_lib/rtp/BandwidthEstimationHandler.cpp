@@ -281,7 +281,7 @@ void BandwidthEstimationHandler::sendREMBPacket()
     if (active_)
     {
         // ELOG_DEBUG("BWE Estimation is %d", last_send_bitrate_);
-        getContext()->fireWrite(std::make_shared<DataPacket>(0,
+        getContext()->fireWrite(makeDataPacket(0,
                                                              reinterpret_cast<char *>(&remb_packet_), remb_length, OTHER_PACKET));
     }
 }
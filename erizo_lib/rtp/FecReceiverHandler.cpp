@@ -63,7 +63,7 @@ void FecReceiverHandler::write(Context *ctx, std::shared_ptr<DataPacket> packet)
 }
 
 bool FecReceiverHandler::OnRecoveredPacket(const uint8_t* rtp_packet, size_t rtp_packet_length) {
-  getContext()->fireWrite(std::make_shared<DataPacket>(0, (char*)rtp_packet, rtp_packet_length, VIDEO_PACKET));  // NOLINT
+  getContext()->fireWrite(makeDataPacket(0, (char*)rtp_packet, rtp_packet_length, VIDEO_PACKET));  // NOLINT
   return true;
 }
 
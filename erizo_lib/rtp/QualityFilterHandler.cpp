@@ -194,6 +194,9 @@ void QualityFilterHandler::write(Context *ctx, std::shared_ptr<DataPacket> packe
       return;
     }
 
+    ensureWritable(packet);
+    rtp_header = reinterpret_cast<RtpHeader*>(packet->data);
+
     if (packet->compatible_spatial_layers.back() == target_spatial_layer_ && packet->ending_of_layer_frame) {
       rtp_header->setMarker(1);
     }
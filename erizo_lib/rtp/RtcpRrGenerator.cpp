@@ -143,7 +143,7 @@ std::shared_ptr<DataPacket> RtcpRrGenerator::generateReceiverReport() {
   uint16_t selected_interval = selectInterval();
   rr_info_.next_packet_ms = now + getRandomValue(0.5 * selected_interval, 1.5 * selected_interval);
   rr_info_.last_packet_ms = now;
-  return (std::make_shared<DataPacket>(0, reinterpret_cast<char*>(&packet_), length, type_));
+  return (makeDataPacket(0, reinterpret_cast<char*>(&packet_), length, type_));
 }
 
 
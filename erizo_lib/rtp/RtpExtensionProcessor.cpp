@@ -64,11 +64,14 @@ bool RtpExtensionProcessor::isValidExtension(std::string uri) {
 }
 
 uint32_t RtpExtensionProcessor::processRtpExtensions(std::shared_ptr<DataPacket> p) {
-  const RtpHeader* head = reinterpret_cast<const RtpHeader*>(p->data);
-  uint32_t len = p->length;
+  return processRtpExtensions(p->data, p->length, p->type);
+}
+
+uint32_t RtpExtensionProcessor::processRtpExtensions(char* buf, int len, packetType type) {
+  const RtpHeader* head = reinterpret_cast<const RtpHeader*>(buf);
   std::array<RTPExtensions, 10> extMap;
   if (head->getExtension()) {
-    switch (p->type) {
+    switch (type) {
       case VIDEO_PACKET:
         extMap = ext_map_video_;
         break;
@@ -32,6 +32,8 @@ class RtpExtensionProcessor{
 
   void setSdpInfo(std::shared_ptr<SdpInfo> theInfo);
   uint32_t processRtpExtensions(std::shared_ptr<DataPacket> p);
+  // Same as above, on a raw RTP buffer owned by the caller (e.g. the SRTP protect buffer)
+  uint32_t processRtpExtensions(char* buf, int len, packetType type);
   VideoRotation getVideoRotation();
 
   std::array<RTPExtensions, 10> getVideoExtensionMap() {
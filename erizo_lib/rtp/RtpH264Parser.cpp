@@ -145,6 +145,7 @@ int RtpH264Parser::parse_aggregated_packet(RTPPayloadH264* h264, unsigned char*
           dst += sizeof(RTPPayloadH264::start_sequence);
           std::memcpy(dst, src, nal_size);
           dst += nal_size;
+          h264->unpacked_nal_sizes.push_back(nal_size);
         }
       } else {
         ELOG_ERROR("NAL size exceeds length: %d %d\n", nal_size, src_len);
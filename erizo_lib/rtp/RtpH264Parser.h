@@ -3,6 +3,7 @@
 
 #include "./logger.h"
 #include <memory>
+#include <vector>
 
 namespace erizo {
 
@@ -29,6 +30,8 @@ struct RTPPayloadH264 {
   unsigned char end_bit = 0;
   std::unique_ptr<unsigned char[]> unpacked_data;
   unsigned unpacked_data_len = 0;
+  // size of each NAL unit in unpacked_data, start sequence excluded
+  std::vector<unsigned> unpacked_nal_sizes;
 };
 
 class RtpH264Parser {
@@ -121,12 +121,16 @@ void RtpPaddingGeneratorHandler::onPacketWithMarkerSet(std::shared_ptr<DataPacke
   }, std::chrono::milliseconds(1000 / kMinMarkerRate));
 }
 
-bool RtpPaddingGeneratorHandler::isHigherSequenceNumber(std::shared_ptr<DataPacket> packet) {
+bool RtpPaddingGeneratorHandler::isHigherSequenceNumber(std::shared_ptr<DataPacket> &packet) {
   RtpHeader *rtp_header = reinterpret_cast<RtpHeader*>(packet->data);
   rtp_header_length_ = rtp_header->getHeaderLength();
   uint16_t new_sequence_number = rtp_header->getSeqNumber();
   SequenceNumber sequence_number = translator_.get(new_sequence_number, false);
-  rtp_header->setSeqNumber(sequence_number.output);
+  if (sequence_number.output != new_sequence_number) {
+    ensureWritable(packet);
+    rtp_header = reinterpret_cast<RtpHeader*>(packet->data);
+    rtp_header->setSeqNumber(sequence_number.output);
+  }
   if (first_packet_received_ && RtpUtils::sequenceNumberLessThan(new_sequence_number, higher_sequence_number_)) {
     return false;
   }
@@ -35,7 +35,7 @@ class RtpPaddingGeneratorHandler: public Handler, public std::enable_shared_from
  private:
   void sendPaddingPacket(std::shared_ptr<DataPacket> packet, uint8_t padding_size);
   void onPacketWithMarkerSet(std::shared_ptr<DataPacket> packet);
-  bool isHigherSequenceNumber(std::shared_ptr<DataPacket> packet);
+  bool isHigherSequenceNumber(std::shared_ptr<DataPacket> &packet);
   void onVideoPacket(std::shared_ptr<DataPacket> packet);
 
   uint64_t getStat(std::string stat_name);
@@ -115,7 +115,11 @@ void RtpSlideShowHandler::write(Context *ctx, std::shared_ptr<DataPacket> packet
   maybeUpdateHighestSeqNum(rtp_header->getSeqNumber());
   SequenceNumber sequence_number_info = translator_.get(packet_seq_num, should_skip_packet);
   if (!should_skip_packet && sequence_number_info.type == SequenceNumberType::Valid) {
-    rtp_header->setSeqNumber(sequence_number_info.output);
+    if (sequence_number_info.output != packet_seq_num) {
+      ensureWritable(packet);
+      rtp_header = reinterpret_cast<RtpHeader*>(packet->data);
+      rtp_header->setSeqNumber(sequence_number_info.output);
+    }
     ELOG_DEBUG("SN %u %d", sequence_number_info.output, is_keyframe);
     last_keyframe_sent_time_ = clock_->now();
     ctx->fireWrite(std::move(packet));
@@ -251,6 +255,7 @@ void RtpSlideShowHandler::maybeSendStoredKeyframe() {
       ELOG_DEBUG("Keyframe sent");
     }
     for (auto packet : stored_keyframe_) {
+      ensureWritable(packet);
       RtpHeader *rtp_header = reinterpret_cast<RtpHeader*>(packet->data);
       rtp_header->setTimestamp(last_timestamp_received_);
       SequenceNumber sequence_number = translator_.generate();
@@ -88,6 +88,7 @@ void RtpTrackMuteHandler::handlePacket(Context *ctx, TrackMuteInfo *info, std::s
   if (!info->mute_is_active) {
     info->last_sent_seq_num = info->last_original_seq_num - offset;
     if (offset > 0) {
+      ensureWritable(packet);
       setPacketSeqNumber(packet, info->last_sent_seq_num);
     }
     ctx->fireWrite(std::move(packet));
@@ -57,6 +57,7 @@ void SRPacketHandler::write(Context *ctx, std::shared_ptr<DataPacket> packet) {
     if (!chead->isRtcp() && enabled_) {
       handleRtpPacket(packet);
     } else if (chead->packettype == RTCP_Sender_PT && enabled_) {
+      ensureWritable(packet);
       handleSR(packet);
     }
   }
@@ -13,15 +13,56 @@ DEFINE_LOGGER(StatsCalculator, "rtp.StatsCalculator");
 DEFINE_LOGGER(IncomingStatsHandler, "rtp.IncomingStatsHandler");
 DEFINE_LOGGER(OutgoingStatsHandler, "rtp.OutgoingStatsHandler");
 
+// Returns parent's child stat called name, inserting initial first if there is none
+template <typename Node>
+static std::shared_ptr<StatNode> childStat(StatNode &parent, const std::string &name, Node&& initial) {  // NOLINT
+  if (!parent.hasChild(name)) {
+    parent.insertStat(name, std::forward<Node>(initial));
+  }
+  return parent.getMap().at(name);
+}
+
 void StatsCalculator::update(MediaStream *stream, std::shared_ptr<Stats> stats) {
   if (!stream_) {
     stream_ = stream;
     stats_ = stats;
-    if (!getStatsInfo().hasChild("total")) {
-      getStatsInfo()["total"].insertStat("bitrateCalculated", MovingIntervalRateStat{kRateStatIntervalSize,
-        kRateStatIntervals, 8.});
+    total_bitrate_ = childStat(getStatsInfo()["total"], "bitrateCalculated",
+        MovingIntervalRateStat{kRateStatIntervalSize, kRateStatIntervals, 8.});
+  }
+}
+
+StatsCalculator::SsrcStats* StatsCalculator::getSsrcStats(uint32_t ssrc) {
+  size_t count = ssrc_stats_.size();
+  for (size_t index = 0; index < count; index++) {
+    size_t position = (last_ssrc_stats_ + index) % count;
+    if (ssrc_stats_[position].ssrc == ssrc) {
+      last_ssrc_stats_ = position;
+      return &ssrc_stats_[position];
     }
   }
+  // Only SSRCs of the stream get a handle, so that stray packets cannot grow the list
+  if (!stream_->isSinkSSRC(ssrc) && !stream_->isSourceSSRC(ssrc)) {
+    return nullptr;
+  }
+  ssrc_stats_.emplace_back(ssrc);
+  last_ssrc_stats_ = ssrc_stats_.size() - 1;
+  return &ssrc_stats_.back();
+}
+
+StatNode& StatsCalculator::getNode(SsrcStats &stats) {
+  if (!stats.node) {
+    std::string key = std::to_string(stats.ssrc);
+    getStatsInfo()[key];
+    stats.node = getStatsInfo().getMap().at(key);
+  }
+  return *stats.node;
+}
+
+void StatsCalculator::notifyStats() {
+  if (stream_) {
+    stream_->updateLatencyStats();
+  }
+  stats_->sendStats();
 }
 
 void StatsCalculator::processPacket(std::shared_ptr<DataPacket> packet) {
@@ -38,35 +79,47 @@ void StatsCalculator::processRtpPacket(std::shared_ptr<DataPacket> packet) {
   int len = packet->length;
   RtpHeader* head = reinterpret_cast<RtpHeader*>(buf);
   uint32_t ssrc = head->getSSRC();
-  if (!stream_->isSinkSSRC(ssrc) && !stream_->isSourceSSRC(ssrc)) {
+  SsrcStats *stats = getSsrcStats(ssrc);
+  if (stats) {
+    // SSRCs only change at signaling time, so the check is redone only when one has changed
+    uint32_t generation = ssrcGeneration();
+    if (!stats->known || stats->generation != generation) {
+      stats->generation = generation;
+      stats->known = stream_->isSinkSSRC(ssrc) || stream_->isSourceSSRC(ssrc);
+    }
+  }
+  if (!stats || !stats->known) {
     ELOG_DEBUG("message: Unknown SSRC in processRtpPacket, ssrc: %u, PT: %u", ssrc, head->getPayloadType());
     return;
   }
-  if (!getStatsInfo()[ssrc].hasChild("bitrateCalculated")) {
-    if (stream_->isVideoSourceSSRC(ssrc) || stream_->isVideoSinkSSRC(ssrc)) {
-      getStatsInfo()[ssrc].insertStat("type", StringStat{"video"});
-    } else if (stream_->isAudioSourceSSRC(ssrc) || stream_->isAudioSinkSSRC(ssrc)) {
-      getStatsInfo()[ssrc].insertStat("type", StringStat{"audio"});
+  if (!stats->bitrate) {
+    StatNode &node = getNode(*stats);
+    if (!node.hasChild("bitrateCalculated")) {
+      if (stream_->isVideoSourceSSRC(ssrc) || stream_->isVideoSinkSSRC(ssrc)) {
+        node.insertStat("type", StringStat{"video"});
+      } else if (stream_->isAudioSourceSSRC(ssrc) || stream_->isAudioSinkSSRC(ssrc)) {
+        node.insertStat("type", StringStat{"audio"});
+      }
     }
-    getStatsInfo()[ssrc].insertStat("bitrateCalculated", MovingIntervalRateStat{kRateStatIntervalSize,
-        kRateStatIntervals, 8.});
+    stats->bitrate = childStat(node, "bitrateCalculated",
+        MovingIntervalRateStat{kRateStatIntervalSize, kRateStatIntervals, 8.});
   }
-  getStatsInfo()[ssrc]["bitrateCalculated"] += len;
-  getStatsInfo()["total"]["bitrateCalculated"] += len;
+  *stats->bitrate += len;
+  *total_bitrate_ += len;
   if (packet->type == VIDEO_PACKET) {
-    stream_->setVideoBitrate(getStatsInfo()[ssrc]["bitrateCalculated"].value());
+    stream_->setVideoBitrate(stats->bitrate->value());
     if (packet->is_keyframe) {
-      incrStat(ssrc, "keyFrames");
+      incrStat(*stats, &SsrcStats::key_frames, "keyFrames");
     }
   }
 }
 
-void StatsCalculator::incrStat(uint32_t ssrc, std::string stat) {
-  if (!getStatsInfo()[ssrc].hasChild(stat)) {
-    getStatsInfo()[ssrc].insertStat(stat, CumulativeStat{1});
-    return;
+void StatsCalculator::incrStat(SsrcStats &stats, Counter counter, const std::string &name) {
+  std::shared_ptr<StatNode> &stat = stats.*counter;
+  if (!stat) {
+    stat = childStat(getNode(stats), name, CumulativeStat{0});
   }
-  getStatsInfo()[ssrc][stat]++;
+  (*stat)++;
 }
 
 void StatsCalculator::processRtcpPacket(std::shared_ptr<DataPacket> packet) {
@@ -93,6 +146,11 @@ void StatsCalculator::processRtcpPacket(std::shared_ptr<DataPacket> packet) {
     }
   }
 
+  // Feedback about an SSRC that is not the stream's goes through a throwaway handle
+  SsrcStats *cached_stats = getSsrcStats(ssrc);
+  SsrcStats uncached_stats{ssrc};
+  SsrcStats &stats = cached_stats ? *cached_stats : uncached_stats;
+
   ELOG_DEBUG("RTCP packet received, type: %u, size: %u, packetLength: %u", chead->getPacketType(),
        ((ntohs(chead->length) + 1) * 4), len);
   do {
@@ -114,35 +172,35 @@ void StatsCalculator::processRtcpPacket(std::shared_ptr<DataPacket> packet) {
           break;
         }
         ELOG_DEBUG("RTP RR: Fraction Lost %u, packetsLost %u", chead->getFractionLost(), chead->getLostPackets());
-        getStatsInfo()[ssrc].insertStat("fractionLost", CumulativeStat{chead->getFractionLost()});
-        getStatsInfo()[ssrc].insertStat("packetsLost", CumulativeStat{chead->getLostPackets()});
-        getStatsInfo()[ssrc].insertStat("jitter", CumulativeStat{chead->getJitter()});
-        getStatsInfo()[ssrc].insertStat("sourceSsrc", CumulativeStat{ssrc});
+        getNode(stats).insertStat("fractionLost", CumulativeStat{chead->getFractionLost()});
+        getNode(stats).insertStat("packetsLost", CumulativeStat{chead->getLostPackets()});
+        getNode(stats).insertStat("jitter", CumulativeStat{chead->getJitter()});
+        getNode(stats).insertStat("sourceSsrc", CumulativeStat{ssrc});
         break;
       case RTCP_Sender_PT:
         ELOG_DEBUG("RTP SR: Packets Sent %u, Octets Sent %u", chead->getPacketsSent(), chead->getOctetsSent());
-        getStatsInfo()[ssrc].insertStat("packetsSent", CumulativeStat{chead->getPacketsSent()});
-        getStatsInfo()[ssrc].insertStat("bytesSent", CumulativeStat{chead->getOctetsSent()});
+        getNode(stats).insertStat("packetsSent", CumulativeStat{chead->getPacketsSent()});
+        getNode(stats).insertStat("bytesSent", CumulativeStat{chead->getOctetsSent()});
         break;
       case RTCP_RTP_Feedback_PT:
         ELOG_DEBUG("RTP FB: Usually NACKs: %u", chead->getBlockCount());
         ELOG_DEBUG("PID %u BLP %u", chead->getNackPid(), chead->getNackBlp());
-        incrStat(ssrc, "NACK");
+        incrStat(stats, &SsrcStats::nack, "NACK");
         break;
       case RTCP_PS_Feedback_PT:
         ELOG_DEBUG("RTCP PS FB TYPE: %u", chead->getBlockCount() );
         switch (chead->getBlockCount()) {
           case RTCP_PLI_FMT:
             ELOG_DEBUG("PLI Packet, SSRC %u, sourceSSRC %u", chead->getSSRC(), chead->getSourceSSRC());
-            incrStat(ssrc, "PLI");
+            incrStat(stats, &SsrcStats::pli, "PLI");
             break;
           case RTCP_SLI_FMT:
             ELOG_DEBUG("SLI Message");
-            incrStat(ssrc, "SLI");
+            incrStat(stats, &SsrcStats::sli, "SLI");
             break;
           case RTCP_FIR_FMT:
             ELOG_DEBUG("FIR Packet, SSRC %u, sourceSSRC %u", chead->getSSRC(), chead->getSourceSSRC());
-            incrStat(ssrc, "FIR");
+            incrStat(stats, &SsrcStats::fir, "FIR");
             break;
           case RTCP_AFB:
             {
@@ -155,7 +213,7 @@ void StatsCalculator::processRtcpPacket(std::shared_ptr<DataPacket> packet) {
                 uint64_t bitrate = chead->getREMBBitRate();
                 // ELOG_DEBUG("REMB Packet numSSRC %u mantissa %u exp %u, tot %lu bps",
                 //             chead->getREMBNumSSRC(), chead->getBrMantis(), chead->getBrExp(), bitrate);
-                getStatsInfo()[ssrc].insertStat("bandwidth", CumulativeStat{bitrate});
+                getNode(stats).insertStat("bandwidth", CumulativeStat{bitrate});
               } else {
                 ELOG_DEBUG("Unsupported AFB Packet not REMB")
               }
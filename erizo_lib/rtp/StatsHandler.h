@@ -1,7 +1,9 @@
 #ifndef ERIZO_SRC_ERIZO_RTP_STATSHANDLER_H_
 #define ERIZO_SRC_ERIZO_RTP_STATSHANDLER_H_
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "./logger.h"
 #include "pipeline/Handler.h"
@@ -28,18 +30,41 @@ class StatsCalculator {
     return stats_->getNode();
   }
 
-  void notifyStats() {
-    stats_->sendStats();
-  }
+  void notifyStats();
 
  private:
+  // Handle on the stats of one SSRC. The nodes live in the Stats tree, so they are serialized
+  // and read by name as before, but the per-packet path reaches them through these pointers
+  // instead of formatting the SSRC and walking the tree by string for every packet.
+  struct SsrcStats {
+    explicit SsrcStats(uint32_t the_ssrc) : ssrc{the_ssrc} {}
+    uint32_t ssrc;
+    // ssrcGeneration() the SSRC was last checked against the stream at
+    uint32_t generation = 0;
+    bool known = false;
+    std::shared_ptr<StatNode> node;
+    std::shared_ptr<StatNode> bitrate;
+    std::shared_ptr<StatNode> key_frames;
+    std::shared_ptr<StatNode> nack;
+    std::shared_ptr<StatNode> pli;
+    std::shared_ptr<StatNode> sli;
+    std::shared_ptr<StatNode> fir;
+  };
+  typedef std::shared_ptr<StatNode> SsrcStats::*Counter;
+
   void processRtpPacket(std::shared_ptr<DataPacket> packet);
   void processRtcpPacket(std::shared_ptr<DataPacket> packet);
-  void incrStat(uint32_t ssrc, std::string stat);
+  SsrcStats* getSsrcStats(uint32_t ssrc);
+  StatNode& getNode(SsrcStats &stats);
+  void incrStat(SsrcStats &stats, Counter counter, const std::string &name);
 
  private:
   MediaStream* stream_;
   std::shared_ptr<Stats> stats_;
+  std::shared_ptr<StatNode> total_bitrate_;
+  // A handful of SSRCs per stream, so a linear scan starting at the last hit beats a map
+  std::vector<SsrcStats> ssrc_stats_;
+  size_t last_ssrc_stats_ = 0;
 };
 
 class IncomingStatsHandler: public InboundHandler, public StatsCalculator {
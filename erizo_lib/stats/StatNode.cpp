@@ -35,6 +35,12 @@ std::string StatNode::toString() {
   return text.str();
 }
 
+void StatNode::flatten(const std::string &path, FlatStats *out) {
+  for (const auto &child : node_map_) {
+    child.second->flatten(path.empty() ? child.first : path + "." + child.first, out);
+  }
+}
+
 StatNode& StringStat::operator=(std::string text) {
   text_ = text;
   return *this;
@@ -5,11 +5,15 @@
 #include <map>
 #include <vector>
 #include <memory>
+#include <utility>
 
 #include "lib/Clock.h"
 
 namespace erizo {
 
+// Numeric leaves of a stats tree, keyed by their dot separated path
+typedef std::vector<std::pair<std::string, uint64_t>> FlatStats;
+
 class StatNode {
  public:
   StatNode() {}
@@ -42,6 +46,9 @@ class StatNode {
 
   virtual std::string toString();
 
+  // Appends every numeric leaf under this node to out, its path prefixed with path
+  virtual void flatten(const std::string &path, FlatStats *out);
+
  private:
   bool is_node_{false};
   std::map<std::string, std::shared_ptr<StatNode>> node_map_;
@@ -82,6 +89,8 @@ class CumulativeStat : public StatNode {
 
   std::string toString() override { return std::to_string(total_); }
 
+  void flatten(const std::string &path, FlatStats *out) override { out->emplace_back(path, value()); }
+
   uint64_t value() override { return total_; }
 
  private:
@@ -102,6 +111,8 @@ class RateStat : public StatNode {
 
   std::string toString() override;
 
+  void flatten(const std::string &path, FlatStats *out) override { out->emplace_back(path, value()); }
+
  private:
   void add(uint64_t value);
   void checkPeriod();
@@ -132,6 +143,7 @@ class MovingIntervalRateStat : public StatNode {
 
   std::string toString() override;
 
+  void flatten(const std::string &path, FlatStats *out) override { out->emplace_back(path, value()); }
 
  private:
   void add(uint64_t value);
@@ -169,6 +181,8 @@ class MovingAverageStat : public StatNode {
 
   std::string toString() override;
 
+  void flatten(const std::string &path, FlatStats *out) override { out->emplace_back(path, value()); }
+
  private:
   void add(uint64_t value);
   double getAverage(uint32_t sample_number);
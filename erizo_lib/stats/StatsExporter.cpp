@@ -0,0 +1,216 @@
+#include "stats/StatsExporter.h"
+
+#include <pthread.h>
+
+#include <chrono>  // NOLINT
+#include <utility>
+
+#include "./MediaStream.h"
+
+namespace erizo {
+
+DEFINE_LOGGER(StatsExporter, "stats.StatsExporter");
+
+static void putVarint(std::string *out, uint64_t value) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+static void putString(std::string *out, const std::string &text) {
+  putVarint(out, text.size());
+  out->append(text);
+}
+
+static uint64_t zigzag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+StatsExporter* StatsExporter::getInstance() {
+  static StatsExporter instance;
+  return &instance;
+}
+
+StatsExporter::StatsExporter() : running_{false}, interval_{std::chrono::seconds(1)}, sequence_{0} {
+}
+
+StatsExporter::~StatsExporter() {
+  close();
+}
+
+void StatsExporter::start(duration interval, BatchSink sink, const std::string &shm_name, size_t shm_size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_) {
+    return;
+  }
+  running_ = true;
+  interval_ = interval;
+  sink_ = sink;
+  sequence_ = 0;
+  if (!shm_name.empty() && shm_ring_.open(shm_name, kShmSlots, shm_size / kShmSlots) != 0) {
+    ELOG_WARN("message: could not open stats shared memory ring, name: %s", shm_name.c_str());
+  }
+  thread_.reset(new std::thread([this] {
+    pthread_setname_np(pthread_self(), "erizo_stats");
+    exportLoop();
+  }));
+}
+
+void StatsExporter::close() {
+  std::unique_ptr<std::thread> thread;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+    thread.swap(thread_);
+  }
+  cond_.notify_all();
+  if (thread && thread->joinable()) {
+    thread->join();
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  sink_ = nullptr;
+  shm_ring_.close();
+  streams_.clear();
+  samples_.clear();
+  removed_.clear();
+  key_ids_.clear();
+  last_values_.clear();
+}
+
+void StatsExporter::addStream(const std::string &name, std::shared_ptr<MediaStream> stream) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Nothing would ever sample it, nor drain its removal
+  if (!running_) {
+    return;
+  }
+  streams_[name] = stream;
+}
+
+void StatsExporter::removeStream(const std::string &name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_ && streams_.erase(name) > 0) {
+    samples_.erase(name);
+    removed_.push_back(name);
+  }
+}
+
+void StatsExporter::collect(const std::string &name, FlatStats stats) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // The stream may be gone by the time its worker answers
+  if (running_ && streams_.find(name) != streams_.end()) {
+    samples_[name] = std::move(stats);
+  }
+}
+
+void StatsExporter::exportLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  time_point next = clock::now() + interval_;
+  while (running_) {
+    if (cond_.wait_until(lock, next, [this] { return !running_; })) {
+      break;
+    }
+    next += interval_;
+
+    // Publish the samples requested on the previous tick, so no tick waits for the workers
+    std::map<std::string, FlatStats> samples;
+    std::vector<std::string> removed;
+    std::vector<std::pair<std::string, std::shared_ptr<MediaStream>>> streams;
+    samples.swap(samples_);
+    removed.swap(removed_);
+    for (auto &entry : streams_) {
+      if (auto stream = entry.second.lock()) {
+        streams.emplace_back(entry.first, stream);
+      }
+    }
+    lock.unlock();
+
+    if (!samples.empty() || !removed.empty()) {
+      publish(encodeBatch(samples, removed));
+    }
+    for (auto &entry : streams) {
+      std::string name = entry.first;
+      entry.second->getFlatStats([this, name](FlatStats stats) {
+        collect(name, std::move(stats));
+      });
+    }
+
+    lock.lock();
+  }
+}
+
+std::string StatsExporter::encodeBatch(const std::map<std::string, FlatStats> &samples,
+                                       const std::vector<std::string> &removed) {
+  bool full_snapshot = sequence_ % kFullSnapshotInterval == 0;
+  if (full_snapshot) {
+    key_ids_.clear();
+    last_values_.clear();
+  }
+  for (const std::string &name : removed) {
+    last_values_.erase(name);
+  }
+
+  std::string keys;
+  std::string streams;
+  uint64_t new_keys = 0;
+  for (const auto &sample : samples) {
+    std::unordered_map<uint64_t, uint64_t> &last = last_values_[sample.first];
+    std::string entries;
+    uint64_t entry_count = 0;
+    for (const auto &stat : sample.second) {
+      auto key = key_ids_.find(stat.first);
+      if (key == key_ids_.end()) {
+        key = key_ids_.emplace(stat.first, key_ids_.size()).first;
+        putVarint(&keys, key->second);
+        putString(&keys, stat.first);
+        new_keys++;
+      }
+      uint64_t &previous = last[key->second];
+      if (!full_snapshot && stat.second == previous) {
+        continue;
+      }
+      putVarint(&entries, key->second);
+      putVarint(&entries, zigzag(static_cast<int64_t>(stat.second - previous)));
+      previous = stat.second;
+      entry_count++;
+    }
+    putString(&streams, sample.first);
+    putVarint(&streams, entry_count);
+    streams.append(entries);
+  }
+
+  std::string batch{"ESTB"};
+  batch.push_back(static_cast<char>(kVersion));
+  batch.push_back(static_cast<char>(full_snapshot ? 1 : 0));
+  putVarint(&batch, sequence_++);
+  putVarint(&batch, std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count());
+  putVarint(&batch, new_keys);
+  batch.append(keys);
+  putVarint(&batch, samples.size());
+  batch.append(streams);
+  putVarint(&batch, removed.size());
+  for (const std::string &name : removed) {
+    putString(&batch, name);
+  }
+  return batch;
+}
+
+void StatsExporter::publish(const std::string &batch) {
+  if (shm_ring_.isOpen() && !shm_ring_.write(batch.data(), batch.size())) {
+    // A full snapshot, see the flags byte after "ESTB" and the version: readers cannot decode
+    // the deltas that follow until the next snapshot fits
+    if (batch[5] & 1) {
+      ELOG_WARN("message: stats snapshot not written to shared memory, size: %zu, capacity: %zu",
+                batch.size(), shm_ring_.capacity());
+    } else {
+      ELOG_DEBUG("message: stats batch not written to shared memory, size: %zu", batch.size());
+    }
+  }
+  if (sink_) {
+    sink_(batch);
+  }
+}
+
+}  // namespace erizo
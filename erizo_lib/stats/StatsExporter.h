@@ -0,0 +1,94 @@
+#ifndef ERIZO_SRC_ERIZO_STATS_STATSEXPORTER_H_
+#define ERIZO_SRC_ERIZO_STATS_STATSEXPORTER_H_
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "./logger.h"
+#include "lib/Clock.h"
+#include "lib/ShmRing.h"
+#include "stats/StatNode.h"
+
+namespace erizo {
+
+class MediaStream;
+
+/*
+ * Node-wide stats aggregator. Every interval it asks each registered MediaStream for its
+ * numeric stats, which are flattened on the stream's own worker, and publishes everything that
+ * came back as one compact binary batch, instead of one JSON message per stream.
+ *
+ * Batch layout, integers as unsigned LEB128 varints unless noted:
+ *   "ESTB", uint8 version (1), uint8 flags (bit 0: full snapshot), sequence, unix time in ms
+ *   key count, then per key: id, name length, name      e.g. "1234.bitrateCalculated"
+ *   stream count, then per stream: name length, name, entry count, then per entry:
+ *     key id, zigzag varint delta
+ *   removed stream count, then per stream: name length, name
+ * A full snapshot is sent every kFullSnapshotInterval batches. It resets the key ids, lists
+ * every key it uses and carries absolute values. Other batches only list the keys they add
+ * and carry each value less the one last published for the same stream and key, skipping the
+ * values that did not change. A consumer that missed a batch resyncs on the next snapshot.
+ *
+ * Batches can also be written to a ShmRing, so that a sidecar reads them without going
+ * through the broker. A batch larger than a slot is split over several, so only a batch larger
+ * than the whole ring is dropped.
+ */
+class StatsExporter {
+  DECLARE_LOGGER();
+
+ public:
+  typedef std::function<void(const std::string&)> BatchSink;
+
+  static constexpr uint8_t kVersion = 1;
+  static constexpr uint32_t kFullSnapshotInterval = 10;
+  static constexpr uint32_t kShmSlots = 8;
+
+  static StatsExporter* getInstance();
+  ~StatsExporter();
+
+  // sink gets every batch on the exporter thread. When shm_name is not empty the batches also
+  // go to a shared memory ring of about shm_size bytes.
+  void start(duration interval, BatchSink sink, const std::string &shm_name, size_t shm_size);
+  void close();
+
+  // No-ops unless the exporter is running; streams added before start() are not exported
+  void addStream(const std::string &name, std::shared_ptr<MediaStream> stream);
+  void removeStream(const std::string &name);
+
+ private:
+  StatsExporter();
+  void exportLoop();
+  void collect(const std::string &name, FlatStats stats);
+  std::string encodeBatch(const std::map<std::string, FlatStats> &samples,
+                          const std::vector<std::string> &removed);
+  void publish(const std::string &batch);
+
+  std::unique_ptr<std::thread> thread_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool running_;
+  duration interval_;
+  BatchSink sink_;
+  ShmRing shm_ring_;
+
+  // Guarded by mutex_
+  std::map<std::string, std::weak_ptr<MediaStream>> streams_;
+  std::map<std::string, FlatStats> samples_;
+  std::vector<std::string> removed_;
+
+  // Exporter thread only
+  uint64_t sequence_;
+  std::unordered_map<std::string, uint64_t> key_ids_;
+  std::map<std::string, std::unordered_map<uint64_t, uint64_t>> last_values_;
+};
+
+}  // namespace erizo
+
+#endif  // ERIZO_SRC_ERIZO_STATS_STATSEXPORTER_H_
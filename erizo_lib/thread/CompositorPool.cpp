@@ -0,0 +1,117 @@
+#include "thread/CompositorPool.h"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <atomic>
+
+using erizo::CompositorPool;
+
+struct CompositorPool::Batch {
+  std::vector<Task> tasks;
+  std::atomic<size_t> next{0};
+  size_t finished{0};
+  std::mutex mutex;
+  std::condition_variable done;
+};
+
+CompositorPool* CompositorPool::getInstance() {
+  static CompositorPool instance;
+  return &instance;
+}
+
+CompositorPool::CompositorPool() : closed_{false} {
+}
+
+CompositorPool::~CompositorPool() {
+  close();
+}
+
+void CompositorPool::start(unsigned int num_threads) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!threads_.empty()) {
+    return;
+  }
+  closed_ = false;
+  for (unsigned int index = 0; index < num_threads; index++) {
+    threads_.push_back(std::unique_ptr<std::thread>(new std::thread([this] {
+      pthread_setname_np(pthread_self(), "erizo_compose");
+      threadLoop();
+    })));
+  }
+}
+
+void CompositorPool::close() {
+  std::vector<std::unique_ptr<std::thread>> threads;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    threads.swap(threads_);
+    pending_.clear();
+  }
+  cond_.notify_all();
+  for (auto& thread : threads) {
+    if (thread->joinable()) {
+      thread->join();
+    }
+  }
+}
+
+void CompositorPool::threadLoop() {
+  for (;;) {
+    std::shared_ptr<Batch> batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this] { return closed_ || !pending_.empty(); });
+      if (closed_) {
+        return;
+      }
+      batch = pending_.back();
+      pending_.pop_back();
+    }
+    drain(batch);
+  }
+}
+
+void CompositorPool::drain(const std::shared_ptr<Batch>& batch) {
+  size_t ran = 0;
+  size_t index;
+  while ((index = batch->next.fetch_add(1)) < batch->tasks.size()) {
+    batch->tasks[index]();
+    ran++;
+  }
+  if (ran > 0) {
+    std::lock_guard<std::mutex> lock(batch->mutex);
+    batch->finished += ran;
+    if (batch->finished == batch->tasks.size()) {
+      batch->done.notify_all();
+    }
+  }
+}
+
+void CompositorPool::runAll(std::vector<Task> tasks) {
+  if (tasks.empty()) {
+    return;
+  }
+  auto batch = std::make_shared<Batch>();
+  batch->tasks.swap(tasks);
+
+  size_t helpers = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!closed_) {
+      // One wake-up per extra task at most, the calling thread takes its share too
+      helpers = std::min(threads_.size(), batch->tasks.size() - 1);
+      for (size_t index = 0; index < helpers; index++) {
+        pending_.push_back(batch);
+      }
+    }
+  }
+  for (size_t index = 0; index < helpers; index++) {
+    cond_.notify_one();
+  }
+
+  drain(batch);
+  std::unique_lock<std::mutex> lock(batch->mutex);
+  batch->done.wait(lock, [&batch] { return batch->finished == batch->tasks.size(); });
+}
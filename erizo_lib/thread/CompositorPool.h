@@ -0,0 +1,46 @@
+#ifndef ERIZO_SRC_ERIZO_THREAD_COMPOSITORPOOL_H_
+#define ERIZO_SRC_ERIZO_THREAD_COMPOSITORPOOL_H_
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace erizo {
+
+/*
+ * Fork-join pool shared by every StreamMixer to composite frame tiles in parallel. It has its
+ * own threads, sized apart from the erizo ThreadPool, so mixing load cannot delay forwarding.
+ * When the pool is not started runAll() simply runs the tasks on the calling thread.
+ */
+class CompositorPool {
+ public:
+  typedef std::function<void()> Task;
+
+  static CompositorPool* getInstance();
+  ~CompositorPool();
+
+  void start(unsigned int num_threads);
+  void close();
+
+  // Runs every task, the calling thread included, and returns once all of them are done
+  void runAll(std::vector<Task> tasks);
+
+ private:
+  struct Batch;
+
+  CompositorPool();
+  void threadLoop();
+  static void drain(const std::shared_ptr<Batch>& batch);
+
+  std::vector<std::unique_ptr<std::thread>> threads_;
+  std::vector<std::shared_ptr<Batch>> pending_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool closed_;
+};
+}  // namespace erizo
+
+#endif  // ERIZO_SRC_ERIZO_THREAD_COMPOSITORPOOL_H_
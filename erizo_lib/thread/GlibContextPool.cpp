@@ -0,0 +1,147 @@
+#include "thread/GlibContextPool.h"
+
+#include <glib.h>
+#include <pthread.h>
+
+using erizo::GlibLoop;
+using erizo::GlibContextPool;
+
+namespace {
+
+gboolean runTask(gpointer user_data) {
+  auto task = reinterpret_cast<GlibLoop::Task*>(user_data);
+  (*task)();
+  return G_SOURCE_REMOVE;
+}
+
+void deleteTask(gpointer user_data) {
+  delete reinterpret_cast<GlibLoop::Task*>(user_data);
+}
+
+}  // namespace
+
+GlibLoop::GlibLoop() : context_{g_main_context_new()}, running_{false} {
+  loop_ = g_main_loop_new(context_, FALSE);
+}
+
+GlibLoop::~GlibLoop() {
+  close();
+  g_main_loop_unref(loop_);
+  g_main_context_unref(context_);
+}
+
+void GlibLoop::start(std::shared_ptr<std::promise<void>> start_promise) {
+  if (running_.exchange(true)) {
+    start_promise->set_value();
+    return;
+  }
+  thread_ = std::unique_ptr<std::thread>(new std::thread([this, start_promise] {
+    pthread_setname_np(pthread_self(), "erizo_glib_loop");
+    g_main_context_push_thread_default(context_);
+    start_promise->set_value();
+    g_main_loop_run(loop_);
+    g_main_context_pop_thread_default(context_);
+  }));
+}
+
+void GlibLoop::close() {
+  {
+    std::lock_guard<std::mutex> lock(invoke_mutex_);
+    if (!running_.exchange(false)) {
+      return;
+    }
+  }
+  g_main_loop_quit(loop_);
+  if (thread_ && thread_->joinable()) {
+    thread_->join();
+  }
+  // Run whatever was queued with invokeSync after the loop stopped, so no caller keeps waiting
+  while (g_main_context_iteration(context_, FALSE)) {
+  }
+}
+
+bool GlibLoop::isLoopThread() {
+  return g_main_context_is_owner(context_);
+}
+
+void GlibLoop::invokeSync(Task f) {
+  if (isLoopThread()) {
+    f();
+    return;
+  }
+  auto done = std::make_shared<std::promise<void>>();
+  {
+    std::unique_lock<std::mutex> lock(invoke_mutex_);
+    if (!running_) {
+      lock.unlock();
+      f();
+      return;
+    }
+    Task* task = new Task([f, done] {
+      f();
+      done->set_value();
+    });
+    g_main_context_invoke_full(context_, G_PRIORITY_DEFAULT, runTask, task, deleteTask);
+  }
+  done->get_future().wait();
+}
+
+GlibContextPool* GlibContextPool::getInstance() {
+  static GlibContextPool instance;
+  return &instance;
+}
+
+GlibContextPool::GlibContextPool() : loops_{} {
+}
+
+GlibContextPool::~GlibContextPool() {
+  close();
+}
+
+void GlibContextPool::start(unsigned int num_loops) {
+  std::lock_guard<std::mutex> lock(loops_mutex_);
+  if (!loops_.empty()) {
+    return;
+  }
+  std::vector<std::shared_ptr<std::promise<void>>> promises;
+  for (unsigned int index = 0; index < num_loops; index++) {
+    auto loop = std::make_shared<GlibLoop>();
+    auto promise = std::make_shared<std::promise<void>>();
+    loop->start(promise);
+    loops_.push_back(loop);
+    promises.push_back(promise);
+  }
+  for (auto promise : promises) {
+    promise->get_future().wait();
+  }
+}
+
+void GlibContextPool::close() {
+  std::vector<std::shared_ptr<GlibLoop>> loops;
+  {
+    std::lock_guard<std::mutex> lock(loops_mutex_);
+    loops.swap(loops_);
+  }
+  for (auto loop : loops) {
+    loop->close();
+  }
+}
+
+bool GlibContextPool::isStarted() {
+  std::lock_guard<std::mutex> lock(loops_mutex_);
+  return !loops_.empty();
+}
+
+std::shared_ptr<GlibLoop> GlibContextPool::getLessUsedLoop() {
+  std::lock_guard<std::mutex> lock(loops_mutex_);
+  if (loops_.empty()) {
+    return nullptr;
+  }
+  std::shared_ptr<GlibLoop> chosen_loop = loops_.front();
+  for (auto loop : loops_) {
+    if (chosen_loop.use_count() > loop.use_count()) {
+      chosen_loop = loop;
+    }
+  }
+  return chosen_loop;
+}
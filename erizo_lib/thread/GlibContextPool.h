@@ -0,0 +1,71 @@
+#ifndef ERIZO_SRC_ERIZO_THREAD_GLIBCONTEXTPOOL_H_
+#define ERIZO_SRC_ERIZO_THREAD_GLIBCONTEXTPOOL_H_
+
+#include <atomic>
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+typedef struct _GMainContext GMainContext;
+typedef struct _GMainLoop GMainLoop;
+
+namespace erizo {
+
+/*
+ * A GMainContext driven by its own GMainLoop thread. Many libnice agents can be attached to
+ * the same context; their callbacks are dispatched from this thread.
+ */
+class GlibLoop {
+ public:
+  typedef std::function<void()> Task;
+  GlibLoop();
+  ~GlibLoop();
+
+  void start(std::shared_ptr<std::promise<void>> start_promise);
+  void close();
+
+  GMainContext* getContext() { return context_; }
+  bool isLoopThread();
+  // Runs f on the loop thread and waits for it to finish. Runs it inline when called from
+  // the loop thread itself or after the loop has been closed.
+  void invokeSync(Task f);
+
+ private:
+  GMainContext* context_;
+  GMainLoop* loop_;
+  std::atomic<bool> running_;
+  // Taken while checking running_ and queueing in invokeSync, and while close() clears
+  // running_, so every queued task is either run by the loop or by the drain in close()
+  std::mutex invoke_mutex_;
+  std::unique_ptr<std::thread> thread_;
+};
+
+/*
+ * Fixed pool of GlibLoops shared by every LibNiceConnection in the process, so ICE costs a
+ * handful of threads instead of one per connection. Connections created while the pool is
+ * not started fall back to a private GMainLoop thread.
+ */
+class GlibContextPool {
+ public:
+  static GlibContextPool* getInstance();
+  ~GlibContextPool();
+
+  void start(unsigned int num_loops);
+  void close();
+  bool isStarted();
+
+  // Returns nullptr when the pool is not started
+  std::shared_ptr<GlibLoop> getLessUsedLoop();
+
+ private:
+  GlibContextPool();
+
+  std::vector<std::shared_ptr<GlibLoop>> loops_;
+  std::mutex loops_mutex_;
+};
+}  // namespace erizo
+
+#endif  // ERIZO_SRC_ERIZO_THREAD_GLIBCONTEXTPOOL_H_
@@ -1,16 +1,26 @@
 #include "thread/IOThreadPool.h"
 
+#include <algorithm>
 #include <memory>
 #include <future>  // NOLINT
 
+constexpr std::chrono::milliseconds kLoadSamplePeriod{1000};
+// Weight of one queued task, and of one holder, against a whole busy worker
+constexpr double kPendingTaskWeight = 0.01;
+constexpr double kHolderWeight = 0.0001;
+// Least load a new holder is expected to bring, while no worker has been measured busy
+constexpr double kMinNewHolderLoad = 0.005;
+
 using erizo::IOThreadPool;
 using erizo::IOWorker;
 
 IOThreadPool::IOThreadPool(unsigned int num_io_workers)
-    : io_workers_{} {
+    : io_workers_{}, last_update_{clock::now()}, holder_utilization_{0.} {
   for (unsigned int index = 0; index < num_io_workers; index++) {
     io_workers_.push_back(std::make_shared<IOWorker>());
   }
+  last_busy_times_.resize(io_workers_.size(), duration{0});
+  utilizations_.resize(io_workers_.size(), 0.);
 }
 
 IOThreadPool::~IOThreadPool() {
@@ -18,13 +28,44 @@ IOThreadPool::~IOThreadPool() {
 }
 
 std::shared_ptr<IOWorker> IOThreadPool::getLessUsedIOWorker() {
-  std::shared_ptr<IOWorker> chosen_io_worker = io_workers_.front();
-  for (auto io_worker : io_workers_) {
-    if (chosen_io_worker.use_count() > io_worker.use_count()) {
-      chosen_io_worker = io_worker;
+  std::lock_guard<std::mutex> lock(mutex_);
+  time_point now = clock::now();
+  if (now - last_update_ >= kLoadSamplePeriod) {
+    double elapsed = std::chrono::duration<double>(now - last_update_).count();
+    double total_utilization = 0;
+    long holders = 0;  // NOLINT
+    for (size_t index = 0; index < io_workers_.size(); index++) {
+      duration busy_time = io_workers_[index]->busyTime();
+      utilizations_[index] = std::chrono::duration<double>(busy_time - last_busy_times_[index]).count() / elapsed;
+      last_busy_times_[index] = busy_time;
+      total_utilization += utilizations_[index];
+      // Not counting the pool's own reference
+      holders += io_workers_[index].use_count() - 1;
+    }
+    holder_utilization_ = holders > 0 ? total_utilization / holders : 0.;
+    last_update_ = now;
+  }
+
+  size_t chosen = 0;
+  double chosen_score = 0;
+  for (size_t index = 0; index < io_workers_.size(); index++) {
+    double score = utilizations_[index] + io_workers_[index]->pendingTasks() * kPendingTaskWeight +
+        io_workers_[index].use_count() * kHolderWeight;
+    if (index == 0 || score < chosen_score) {
+      chosen = index;
+      chosen_score = score;
     }
   }
-  return chosen_io_worker;
+  // Until the next sample the new holder counts as an average one, so that the transports
+  // created in a burst do not all land on the same worker
+  utilizations_[chosen] += std::max(holder_utilization_, kMinNewHolderLoad);
+  return io_workers_[chosen];
+}
+
+void IOThreadPool::setBusyPoll(duration max_spin) {
+  for (auto io_worker : io_workers_) {
+    io_worker->setBusyPoll(max_spin);
+  }
 }
 
 void IOThreadPool::start() {
@@ -2,24 +2,40 @@
 #define ERIZO_SRC_ERIZO_THREAD_IOTHREADPOOL_H_
 
 #include <memory>
+#include <mutex>  // NOLINT
 #include <vector>
 
+#include "lib/Clock.h"
 #include "thread/IOWorker.h"
 #include "thread/Scheduler.h"
 
 namespace erizo {
 
+/*
+ * Transports cannot leave the IOWorker they were created on, so IO workers are only balanced at
+ * placement: the least busy over the last sampling period wins, queued tasks count too, and the
+ * number of holders only breaks ties. Until the next sample a new holder counts as much as the
+ * average holder did over the last period.
+ */
 class IOThreadPool {
  public:
   explicit IOThreadPool(unsigned int num_workers);
   ~IOThreadPool();
 
   std::shared_ptr<IOWorker> getLessUsedIOWorker();
+  // See IOWorker::setBusyPoll(), call it before start()
+  void setBusyPoll(duration max_spin);
   void start();
   void close();
 
  private:
   std::vector<std::shared_ptr<IOWorker>> io_workers_;
+  std::mutex mutex_;
+  std::vector<duration> last_busy_times_;
+  std::vector<double> utilizations_;
+  time_point last_update_;
+  // Mean utilization of a holder over the last sampling period
+  double holder_utilization_;
 };
 }  // namespace erizo
 
@@ -6,15 +6,35 @@ extern "C" {
 #include <async_timer.h>
 }
 
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <chrono>  // NOLINT
 
 using erizo::IOWorker;
 
-IOWorker::IOWorker() : started_{false}, closed_{false} {
+// Shortest spin worth adapting from when busy polling
+constexpr std::chrono::microseconds kMinSpin{10};
+// Bounds a sleep in case a wake-up is ever missed
+constexpr int kSleepTimeoutMs = 1000;
+
+IOWorker::IOWorker() : started_{false}, closed_{false}, tasks_{kTaskQueueSize}, pending_tasks_{0},
+    sleeping_{false}, wakeup_fd_{eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)}, max_spin_{0}, spin_{0},
+    busy_time_{0} {
 }
 
 IOWorker::~IOWorker() {
   close();
+  if (wakeup_fd_ >= 0) {
+    ::close(wakeup_fd_);
+  }
+}
+
+void IOWorker::setBusyPoll(duration max_spin) {
+  max_spin_ = std::max(max_spin, duration{0});
+  spin_ = max_spin_;
 }
 
 void IOWorker::start() {
@@ -29,40 +49,118 @@ void IOWorker::start(std::shared_ptr<std::promise<void>> start_promise) {
 
   thread_ = std::unique_ptr<std::thread>(new std::thread([this, start_promise] {
     pthread_setname_np(pthread_self(), "erizo_io_worker");
+    thread_id_ = std::this_thread::get_id();
     start_promise->set_value();
-    while (!closed_) {
-      std::vector<Task> tasks;
-      {
-        std::unique_lock<std::mutex> lk(task_mutex_);
-        task_cond_.wait_for(lk, std::chrono::milliseconds(1000));
-        if(tasks_.size() <= 0) {
-          continue;
-        }
-        
-        {
-          tasks.swap(tasks_);
-        }
-      }
-      
-      for (Task &task : tasks) {
-        task();
-      }
-    }
+    run();
   }));
 }
 
+void IOWorker::run() {
+  while (!closed_) {
+    if (runTasks()) {
+      continue;
+    }
+    if (max_spin_ > duration{0} && spin()) {
+      continue;
+    }
+    sleep();
+  }
+}
+
+bool IOWorker::runTasks() {
+  time_point start = clock::now();
+  bool ran = false;
+  Task task;
+  while (tasks_.pop(&task)) {
+    pending_tasks_--;
+    task();
+    ran = true;
+  }
+  if (!overflow_tasks_.empty()) {
+    std::vector<Task> overflow_tasks;
+    overflow_tasks.swap(overflow_tasks_);
+    for (Task &overflow_task : overflow_tasks) {
+      pending_tasks_--;
+      overflow_task();
+    }
+    ran = true;
+  }
+  if (ran) {
+    busy_time_ += (clock::now() - start).count();
+  }
+  return ran;
+}
+
+bool IOWorker::spin() {
+  time_point deadline = clock::now() + spin_;
+  do {
+    if (runTasks()) {
+      // Caught a task, so spinning pays off: spin longer next time
+      spin_ = std::min(spin_ * 2, max_spin_);
+      return true;
+    }
+  } while (!closed_ && clock::now() < deadline);
+  spin_ = std::max(spin_ / 2, std::min<duration>(kMinSpin, max_spin_));
+  return false;
+}
+
+void IOWorker::sleep() {
+  sleeping_ = true;
+  // Pairs with the fence in task(): either the producer sees sleeping_ or we see its task
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (runTasks() || closed_) {
+    sleeping_ = false;
+    return;
+  }
+  struct pollfd wakeup = {wakeup_fd_, POLLIN, 0};
+  poll(&wakeup, 1, kSleepTimeoutMs);
+  uint64_t count;
+  while (read(wakeup_fd_, &count, sizeof(count)) > 0) {
+  }
+  sleeping_ = false;
+}
+
+void IOWorker::wakeUp() {
+  uint64_t one = 1;
+  if (write(wakeup_fd_, &one, sizeof(one)) < 0) {
+    // The counter is already non zero, the worker is waking up anyway
+  }
+}
+
 void IOWorker::task(Task f) {
-  std::unique_lock<std::mutex> lock(task_mutex_);
-  tasks_.push_back(f);
-  task_cond_.notify_one();
+  // Nothing pops the ring once closed, so waiting for room would never end
+  if (closed_) {
+    return;
+  }
+  pending_tasks_++;
+  while (!tasks_.push(std::move(f))) {
+    if (closed_) {
+      pending_tasks_--;
+      return;
+    }
+    if (std::this_thread::get_id() == thread_id_) {
+      // The worker cannot wait for itself to make room
+      overflow_tasks_.push_back(std::move(f));
+      return;
+    }
+    wakeUp();
+    std::this_thread::yield();
+  }
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleeping_) {
+    wakeUp();
+  }
 }
 
 void IOWorker::close() {
   if (!closed_.exchange(true)) {
-    task_cond_.notify_one();
+    wakeUp();
     if (thread_ != nullptr) {
       thread_->join();
     }
-    tasks_.clear();
+    Task task;
+    while (tasks_.pop(&task)) {
+    }
+    overflow_tasks_.clear();
   }
 }
@@ -2,34 +2,66 @@
 #define ERIZO_SRC_ERIZO_THREAD_IOWORKER_H_
 
 #include <atomic>
+#include <functional>
 #include <memory>
-#include <mutex>  // NOLINT
 #include <future>  // NOLINT
 #include <thread>  // NOLINT
 #include <vector>
-#include <condition_variable>
+
+#include "lib/Clock.h"
+#include "lib/MpscRing.h"
 
 namespace erizo {
 
+/*
+ * Runs tasks posted from any thread, in order, on its own thread. task() pushes into a lock-free
+ * MPSC ring whose cells are allocated once, and only writes the worker's eventfd when the
+ * worker is asleep, so posting takes no lock and usually no syscall. The worker sleeps in
+ * poll() on that eventfd. With busy polling it first spins for a while, the spin growing while
+ * it catches tasks and shrinking while it does not.
+ */
 class IOWorker : public std::enable_shared_from_this<IOWorker> {
  public:
   typedef std::function<void()> Task;
+
+  static constexpr size_t kTaskQueueSize = 4096;
+
   IOWorker();
   ~IOWorker();
 
+  // Longest the worker spins before sleeping, 0 to always sleep. Set it before start().
+  void setBusyPoll(duration max_spin);
+
   virtual void start();
   virtual void start(std::shared_ptr<std::promise<void>> start_promise);
   virtual void close();
 
+  // Drops f once the worker is closed
   virtual void task(Task f);
 
+  size_t pendingTasks() const { return pending_tasks_; }
+  duration busyTime() const { return duration{busy_time_.load()}; }
+
  private:
+  void run();
+  bool runTasks();
+  bool spin();
+  void sleep();
+  void wakeUp();
+
   std::atomic<bool> started_;
   std::atomic<bool> closed_;
   std::unique_ptr<std::thread> thread_;
-  std::vector<Task> tasks_;
-  mutable std::mutex task_mutex_;
-  std::condition_variable task_cond_;
+  std::atomic<std::thread::id> thread_id_;
+  MpscRing<Task> tasks_;
+  // Posted by the worker to itself while the ring was full, worker thread only
+  std::vector<Task> overflow_tasks_;
+  std::atomic<size_t> pending_tasks_;
+  std::atomic<bool> sleeping_;
+  int wakeup_fd_;
+  duration max_spin_;
+  duration spin_;
+  std::atomic<duration::rep> busy_time_;
 };
 }  // namespace erizo
 
@@ -1,31 +1,150 @@
 #include "thread/ThreadPool.h"
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 
-constexpr int kNumThreadsPerScheduler = 2;
+// Only runs the rebalancing, workers run their own timers
+constexpr int kNumThreadsPerScheduler = 1;
+constexpr std::chrono::milliseconds kRebalancePeriod{1000};
+// Utilization gap between the busiest and the idlest worker that triggers a move
+constexpr double kRebalanceGap = 0.25;
+// A lane stays where it was moved at least this long, so that it cannot bounce
+constexpr std::chrono::seconds kMinMoveInterval{10};
+// Weight of one queued task, and of one lane, against a whole busy worker
+constexpr double kPendingTaskWeight = 0.01;
+constexpr double kLaneWeight = 0.0001;
+// Least load a new lane is expected to bring, while no lane has been measured busy
+constexpr double kMinNewLaneLoad = 0.005;
 
 using erizo::ThreadPool;
 using erizo::Worker;
+using erizo::MigratableWorker;
+using erizo::WorkerLoad;
 
 ThreadPool::ThreadPool(unsigned int num_workers)
-    : workers_{}, scheduler_{std::make_shared<Scheduler>(kNumThreadsPerScheduler)} {
+    : workers_{}, scheduler_{std::make_shared<Scheduler>(kNumThreadsPerScheduler)},
+      last_update_{clock::now()}, lane_utilization_{0.}, closed_{false} {
   for (unsigned int index = 0; index < num_workers; index++) {
-    workers_.push_back(std::make_shared<Worker>(scheduler_));
+    workers_.push_back(std::make_shared<Worker>());
   }
+  loads_.resize(workers_.size(), WorkerLoad{0., 0, 0});
 }
 
 ThreadPool::~ThreadPool() {
   close();
 }
 
+size_t ThreadPool::indexOf(const std::shared_ptr<Worker> &worker) {
+  auto found = std::find(workers_.begin(), workers_.end(), worker);
+  return found - workers_.begin();
+}
+
 std::shared_ptr<Worker> ThreadPool::getLessUsedWorker() {
-  std::shared_ptr<Worker> chosen_worker = workers_.front();
-  for (auto worker : workers_) {
-    if (chosen_worker.use_count() > worker.use_count()) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t chosen = 0;
+  double chosen_score = 0;
+  for (size_t index = 0; index < workers_.size(); index++) {
+    const WorkerLoad &load = loads_[index];
+    double score = load.utilization + load.pending_tasks * kPendingTaskWeight + load.lanes * kLaneWeight;
+    if (index == 0 || score < chosen_score) {
+      chosen = index;
+      chosen_score = score;
+    }
+  }
+  auto lane = std::make_shared<MigratableWorker>(workers_[chosen]);
+  lanes_.push_back(Lane{lane, duration{0}, time_point{}, 0.});
+  // The loads are only measured once per period: count the new lane as an average one until
+  // then, so that the lanes created in a burst do not all land on the same worker
+  loads_[chosen].utilization += std::max(lane_utilization_, kMinNewLaneLoad);
+  loads_[chosen].lanes++;
+  return lane;
+}
+
+std::vector<WorkerLoad> ThreadPool::getWorkerLoads() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return loads_;
+}
+
+void ThreadPool::updateLoads() {
+  time_point now = clock::now();
+  double elapsed = std::chrono::duration<double>(now - last_update_).count();
+  last_update_ = now;
+  std::fill(loads_.begin(), loads_.end(), WorkerLoad{0., 0, 0});
+  double total_utilization = 0;
+
+  for (auto lane = lanes_.begin(); lane != lanes_.end();) {
+    std::shared_ptr<MigratableWorker> worker = lane->worker.lock();
+    if (!worker) {
+      lane = lanes_.erase(lane);
+      continue;
+    }
+    duration busy_time = worker->busyTime();
+    lane->utilization = elapsed > 0 ? std::chrono::duration<double>(busy_time - lane->last_busy_time).count() / elapsed : 0;
+    lane->last_busy_time = busy_time;
+    total_utilization += lane->utilization;
+    size_t index = indexOf(worker->getTarget());
+    if (index < loads_.size()) {
+      loads_[index].utilization += lane->utilization;
+      loads_[index].pending_tasks += worker->pendingTasks();
+      loads_[index].lanes++;
+    }
+    ++lane;
+  }
+  lane_utilization_ = lanes_.empty() ? 0. : total_utilization / lanes_.size();
+}
+
+void ThreadPool::rebalance() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  updateLoads();
+  if (workers_.size() < 2) {
+    return;
+  }
+  auto by_utilization = [](const WorkerLoad &a, const WorkerLoad &b) { return a.utilization < b.utilization; };
+  size_t idlest = std::min_element(loads_.begin(), loads_.end(), by_utilization) - loads_.begin();
+  size_t busiest = std::max_element(loads_.begin(), loads_.end(), by_utilization) - loads_.begin();
+  double gap = loads_[busiest].utilization - loads_[idlest].utilization;
+  if (gap < kRebalanceGap) {
+    return;
+  }
+
+  // The lane that best evens the two workers out, so it has to carry less than the whole gap
+  time_point now = clock::now();
+  Lane *chosen = nullptr;
+  std::shared_ptr<MigratableWorker> chosen_worker;
+  double chosen_distance = gap / 2;
+  for (Lane &lane : lanes_) {
+    std::shared_ptr<MigratableWorker> worker = lane.worker.lock();
+    if (!worker || lane.utilization <= 0 || lane.utilization >= gap ||
+        now - lane.last_move < kMinMoveInterval || indexOf(worker->getTarget()) != busiest) {
+      continue;
+    }
+    double distance = std::abs(lane.utilization - gap / 2);
+    if (distance < chosen_distance) {
+      chosen = &lane;
       chosen_worker = worker;
+      chosen_distance = distance;
     }
   }
-  return chosen_worker;
+  if (!chosen) {
+    return;
+  }
+  chosen_worker->moveTo(workers_[idlest]);
+  chosen->last_move = now;
+  loads_[busiest].utilization -= chosen->utilization;
+  loads_[busiest].lanes--;
+  loads_[idlest].utilization += chosen->utilization;
+  loads_[idlest].lanes++;
+}
+
+void ThreadPool::scheduleRebalance() {
+  if (closed_) {
+    return;
+  }
+  scheduler_->scheduleFromNow([this] {
+    rebalance();
+    scheduleRebalance();
+  }, kRebalancePeriod);
 }
 
 void ThreadPool::start() {
@@ -38,9 +157,12 @@ void ThreadPool::start() {
   for (auto promise : promises) {
     promise->get_future().wait();
   }
+  scheduleRebalance();
 }
 
 void ThreadPool::close() {
+  // Stops the rebalancing task rescheduling itself, so that the scheduler can drain
+  closed_ = true;
   for (auto worker : workers_) {
     worker->close();
   }
@@ -1,26 +1,65 @@
 #ifndef ERIZO_SRC_ERIZO_THREAD_THREADPOOL_H_
 #define ERIZO_SRC_ERIZO_THREAD_THREADPOOL_H_
 
+#include <atomic>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <vector>
 
+#include "lib/Clock.h"
 #include "thread/Worker.h"
 #include "thread/Scheduler.h"
 
 namespace erizo {
 
+struct WorkerLoad {
+  // share of the last period the worker spent running tasks, plus the expected load of the lanes
+  // placed on it since
+  double utilization;
+  size_t pending_tasks;
+  size_t lanes;
+};
+
+/*
+ * Every getLessUsedWorker() caller gets its own MigratableWorker lane, placed on the worker with
+ * the lowest measured load: busy time over the last period plus queued tasks, the number of
+ * lanes only breaking ties. Until the next measurement a new lane counts as much as the average
+ * lane did over the last period. Every period the pool also moves one lane from the busiest worker to
+ * the idlest when they are far apart, so that a few hot streams do not keep sharing a thread.
+ */
 class ThreadPool {
  public:
   explicit ThreadPool(unsigned int num_workers);
   ~ThreadPool();
 
   std::shared_ptr<Worker> getLessUsedWorker();
+  std::vector<WorkerLoad> getWorkerLoads();
   void start();
   void close();
 
+ private:
+  struct Lane {
+    std::weak_ptr<MigratableWorker> worker;
+    duration last_busy_time;
+    time_point last_move;
+    double utilization;
+  };
+
+  size_t indexOf(const std::shared_ptr<Worker> &worker);
+  void updateLoads();
+  void rebalance();
+  void scheduleRebalance();
+
  private:
   std::vector<std::shared_ptr<Worker>> workers_;
   std::shared_ptr<Scheduler> scheduler_;
+  std::mutex mutex_;
+  std::vector<Lane> lanes_;
+  std::vector<WorkerLoad> loads_;
+  time_point last_update_;
+  // Mean utilization of a lane over the last period
+  double lane_utilization_;
+  std::atomic<bool> closed_;
 };
 }  // namespace erizo
 
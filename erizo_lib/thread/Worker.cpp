@@ -9,6 +9,7 @@
 #include "lib/ClockUtils.h"
 
 using erizo::Worker;
+using erizo::MigratableWorker;
 using erizo::SimulatedWorker;
 using erizo::ScheduledTaskReference;
 
@@ -22,12 +23,15 @@ void ScheduledTaskReference::cancel() {
   cancelled = true;
 }
 
-Worker::Worker(std::weak_ptr<Scheduler> scheduler, std::shared_ptr<Clock> the_clock)
-    : scheduler_{scheduler},
-      clock_{the_clock},
+Worker::Worker(std::shared_ptr<Clock> the_clock)
+    : clock_{the_clock},
       service_{},
       service_worker_{new asio_worker::element_type(service_)},
-      closed_{false} {
+      closed_{false},
+      thread_id_{},
+      timers_{the_clock->now()},
+      timer_{service_},
+      armed_at_{time_point::max()} {
 }
 
 Worker::~Worker() {
@@ -45,6 +49,7 @@ void Worker::start() {
 void Worker::start(std::shared_ptr<std::promise<void>> start_promise) {
   auto this_ptr = shared_from_this();
   auto worker = [this_ptr, start_promise] {
+    this_ptr->thread_id_ = std::this_thread::get_id();
     start_promise->set_value();
     if (!this_ptr->closed_) {
       return this_ptr->service_.run();
@@ -56,29 +61,66 @@ void Worker::start(std::shared_ptr<std::promise<void>> start_promise) {
 
 void Worker::close() {
   closed_ = true;
+  // A pending wait would keep the service running
+  service_.post([this] {
+    timer_.cancel();
+    timers_.clear();
+  });
   service_worker_.reset();
   group_.join_all();
   service_.stop();
 }
 
 std::shared_ptr<ScheduledTaskReference> Worker::scheduleFromNow(Task f, duration delta) {
-  auto delta_ms = std::chrono::duration_cast<std::chrono::milliseconds>(delta);
   auto id = std::make_shared<ScheduledTaskReference>();
-  if (auto scheduler = scheduler_.lock()) {
-    scheduler->scheduleFromNow(safeTask([f, id](std::shared_ptr<Worker> this_ptr) {
-      this_ptr->task(this_ptr->safeTask([f, id](std::shared_ptr<Worker> this_ptr) {
-        {
-          if (id->isCancelled()) {
-            return;
-          }
-        }
-        f();
-      }));
-    }), delta_ms);
+  time_point when = clock_->now() + delta;
+  Task timer_task = [f, id] {
+    if (id->isCancelled()) {
+      return;
+    }
+    f();
+  };
+  if (std::this_thread::get_id() == thread_id_) {
+    addTimer(when, timer_task);
+  } else {
+    service_.post(safeTask([when, timer_task](std::shared_ptr<Worker> this_ptr) {
+      this_ptr->addTimer(when, timer_task);
+    }));
   }
   return id;
 }
 
+void Worker::addTimer(time_point when, Task f) {
+  timers_.add(when, f);
+  if (when < armed_at_) {
+    armTimer();
+  }
+}
+
+void Worker::armTimer() {
+  armed_at_ = timers_.nextExpiry();
+  if (closed_ || armed_at_ == time_point::max()) {
+    return;
+  }
+  // Replaces any earlier wait, whose handler then gets operation_aborted
+  timer_.expires_from_now(armed_at_ - clock_->now());
+  std::weak_ptr<Worker> weak_this = shared_from_this();
+  timer_.async_wait([weak_this](const boost::system::error_code &error) {
+    if (error) {
+      return;
+    }
+    if (auto this_ptr = weak_this.lock()) {
+      this_ptr->onTimer();
+    }
+  });
+}
+
+void Worker::onTimer() {
+  armed_at_ = time_point::max();
+  timers_.advance(clock_->now());
+  armTimer();
+}
+
 void Worker::scheduleEvery(ScheduledTask f, duration period) {
   scheduleEvery(f, period, period);
 }
@@ -109,8 +151,115 @@ std::function<void()> Worker::safeTask(std::function<void(std::shared_ptr<Worker
   };
 }
 
+MigratableWorker::MigratableWorker(std::shared_ptr<Worker> target)
+    : Worker(),
+      target_{target},
+      moving_{false},
+      closed_{false},
+      pending_tasks_{0},
+      busy_time_{0} {
+}
+
+void MigratableWorker::task(Task f) {
+  auto this_ptr = std::static_pointer_cast<MigratableWorker>(shared_from_this());
+  Task timed_task = [this_ptr, f] {
+    time_point start = clock::now();
+    f();
+    this_ptr->busy_time_ += (clock::now() - start).count();
+    this_ptr->pending_tasks_--;
+  };
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_) {
+    return;
+  }
+  pending_tasks_++;
+  if (moving_) {
+    held_tasks_.push_back(timed_task);
+    return;
+  }
+  target_->task(timed_task);
+}
+
+std::shared_ptr<ScheduledTaskReference> MigratableWorker::scheduleFromNow(Task f, duration delta) {
+  auto id = std::make_shared<ScheduledTaskReference>();
+  std::weak_ptr<MigratableWorker> weak_this = std::static_pointer_cast<MigratableWorker>(shared_from_this());
+  std::shared_ptr<Worker> target = getTarget();
+  std::weak_ptr<Worker> weak_target = target;
+  target->scheduleFromNow([weak_this, weak_target, f, id] {
+    if (id->isCancelled()) {
+      return;
+    }
+    if (auto this_ptr = weak_this.lock()) {
+      this_ptr->runTimer(weak_target.lock(), f);
+    }
+  }, delta);
+  return id;
+}
+
+void MigratableWorker::runTimer(std::shared_ptr<Worker> worker, const Task &f) {
+  bool moved;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) {
+      return;
+    }
+    moved = target_ != worker;
+  }
+  if (moved) {
+    // The lane moved while the timer was pending, it runs in order where the lane is now
+    task(f);
+    return;
+  }
+  // Still on this worker: if a move has started, its fence is queued behind us on this thread
+  time_point start = clock::now();
+  f();
+  busy_time_ += (clock::now() - start).count();
+}
+
+void MigratableWorker::start() {
+}
+
+void MigratableWorker::start(std::shared_ptr<std::promise<void>> start_promise) {
+  start_promise->set_value();
+}
+
+void MigratableWorker::close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  closed_ = true;
+  held_tasks_.clear();
+}
+
+void MigratableWorker::moveTo(std::shared_ptr<Worker> target) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_ || moving_ || !target || target == target_) {
+    return;
+  }
+  moving_ = true;
+  auto this_ptr = std::static_pointer_cast<MigratableWorker>(shared_from_this());
+  // Runs after every task queued so far on the current target
+  target_->task([this_ptr, target] {
+    this_ptr->finishMove(target);
+  });
+}
+
+void MigratableWorker::finishMove(std::shared_ptr<Worker> target) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  target_ = target;
+  for (Task &held_task : held_tasks_) {
+    target_->task(held_task);
+  }
+  held_tasks_.clear();
+  moving_ = false;
+}
+
+std::shared_ptr<Worker> MigratableWorker::getTarget() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return target_;
+}
+
 SimulatedWorker::SimulatedWorker(std::shared_ptr<SimulatedClock> the_clock)
-    : Worker(std::make_shared<Scheduler>(1), the_clock), clock_{the_clock} {
+    : Worker(the_clock), clock_{the_clock} {
 }
 
 void SimulatedWorker::task(Task f) {
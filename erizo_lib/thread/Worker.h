@@ -2,18 +2,21 @@
 #define ERIZO_SRC_ERIZO_THREAD_WORKER_H_
 
 #include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/thread.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono> // NOLINT
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <future>  // NOLINT
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "lib/Clock.h"
-
-#include "thread/Scheduler.h"
+#include "lib/TimerWheel.h"
 
 namespace erizo {
 
@@ -32,8 +35,7 @@ class Worker : public std::enable_shared_from_this<Worker> {
   typedef std::function<void()> Task;
   typedef std::function<bool()> ScheduledTask;
 
-  explicit Worker(std::weak_ptr<Scheduler> scheduler,
-                  std::shared_ptr<Clock> the_clock = std::make_shared<SteadyClock>());
+  explicit Worker(std::shared_ptr<Clock> the_clock = std::make_shared<SteadyClock>());
   ~Worker();
 
   virtual void task(Task f);
@@ -42,6 +44,8 @@ class Worker : public std::enable_shared_from_this<Worker> {
   virtual void start(std::shared_ptr<std::promise<void>> start_promise);
   virtual void close();
 
+  // Delayed tasks live in a timer wheel run by the worker's own thread. Scheduling from that
+  // thread inserts directly, from any other it costs one post.
   virtual std::shared_ptr<ScheduledTaskReference> scheduleFromNow(Task f, duration delta);
   virtual void unschedule(std::shared_ptr<ScheduledTaskReference> id);
 
@@ -50,17 +54,63 @@ class Worker : public std::enable_shared_from_this<Worker> {
  private:
   void scheduleEvery(ScheduledTask f, duration period, duration next_delay);
   std::function<void()> safeTask(std::function<void(std::shared_ptr<Worker>)> f);
+  void addTimer(time_point when, Task f);
+  void armTimer();
+  void onTimer();
 
  protected:
   int next_scheduled_ = 0;
 
  private:
-  std::weak_ptr<Scheduler> scheduler_;
   std::shared_ptr<Clock> clock_;
   boost::asio::io_service service_;
   asio_worker service_worker_;
   boost::thread_group group_;
   std::atomic<bool> closed_;
+  std::atomic<std::thread::id> thread_id_;
+  // Worker thread only
+  TimerWheel timers_;
+  boost::asio::steady_timer timer_;
+  time_point armed_at_;
+};
+
+/*
+ * One stream's serial lane on a pool Worker. The stream posts and schedules everything through
+ * its lane, which measures the time the stream keeps the worker busy and can move the stream to
+ * another Worker while it runs. Order is kept across a move: tasks posted during the move are
+ * held back until everything already queued on the old Worker has run.
+ */
+class MigratableWorker : public Worker {
+ public:
+  explicit MigratableWorker(std::shared_ptr<Worker> target);
+
+  void task(Task f) override;
+  // The timer goes in the target's wheel and runs there unless the lane has moved since
+  std::shared_ptr<ScheduledTaskReference> scheduleFromNow(Task f, duration delta) override;
+
+  // The lane runs on its target's thread, it has none of its own to start or stop
+  void start() override;
+  void start(std::shared_ptr<std::promise<void>> start_promise) override;
+  void close() override;
+
+  // Returns at once, the move completes on the current target
+  void moveTo(std::shared_ptr<Worker> target);
+  std::shared_ptr<Worker> getTarget();
+
+  size_t pendingTasks() const { return pending_tasks_; }
+  duration busyTime() const { return duration{busy_time_.load()}; }
+
+ private:
+  void finishMove(std::shared_ptr<Worker> target);
+  void runTimer(std::shared_ptr<Worker> worker, const Task &f);
+
+  std::mutex mutex_;
+  std::shared_ptr<Worker> target_;
+  bool moving_;
+  bool closed_;
+  std::vector<Task> held_tasks_;
+  std::atomic<size_t> pending_tasks_;
+  std::atomic<duration::rep> busy_time_;
 };
 
 class SimulatedWorker : public Worker {
@@ -0,0 +1,203 @@
+/*
+ * bridge_stream_table_stress: hammers the ShardedRegistry behind BridgeIO's stream table.
+ * Reader threads look handles up lock free and go quiescent every few lookups, like the
+ * BridgeIO receive threads in onRecv, the first of them also reclaiming retired tables, while
+ * writer threads add and remove streams.
+ *
+ *   bridge_stream_table_stress [readers] [writers] [seconds]
+ *
+ * Every handle has a single writer that bumps its generation right before and right after each
+ * add and remove, so generation % 4 is 0 while unregistered, 1 while adding, 2 while registered
+ * and 3 while removing. Every stream remembers the generation it was registered at. A lookup
+ * fails when it
+ *   - returns a stream registered under another handle,
+ *   - returns a stream that was already destroyed,
+ *   - returns a stream whose removal had completed before the lookup started (stale hit),
+ *   - misses a handle that was registered for the whole lookup.
+ * At the end every stream must be destroyed and no retired table left behind.
+ */
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "lib/ShardedRegistry.h"
+
+using erizo::ShardedRegistry;
+
+namespace {
+
+// Same shard count as BRIDGE_STREAM_SHARDS
+constexpr int kShards = 16;
+constexpr uint32_t kAlive = 0xa11ea11e;
+constexpr uint32_t kDead = 0xdeaddead;
+constexpr int kLookupsPerQuiescent = 64;
+
+std::atomic<int64_t> live_streams{0};
+
+struct FakeStream {
+  FakeStream(uint32_t the_handle, uint64_t the_generation)
+      : magic{kAlive}, handle{the_handle}, generation{the_generation} {
+    live_streams++;
+  }
+  ~FakeStream() {
+    magic = kDead;
+    live_streams--;
+  }
+  std::atomic<uint32_t> magic;
+  uint32_t handle;
+  uint64_t generation;
+};
+
+typedef ShardedRegistry<FakeStream, kShards> Registry;
+
+struct HandleState {
+  std::atomic<uint64_t> generation{0};
+  std::shared_ptr<FakeStream> stream;  // writer only
+};
+
+struct Errors {
+  std::atomic<uint64_t> wrong_handle{0};
+  std::atomic<uint64_t> destroyed{0};
+  std::atomic<uint64_t> stale{0};
+  std::atomic<uint64_t> missed{0};
+  std::atomic<uint64_t> writer{0};
+};
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int num_readers = argc > 1 ? atoi(argv[1]) : 4;
+  int num_writers = argc > 2 ? atoi(argv[2]) : 2;
+  int seconds = argc > 3 ? atoi(argv[3]) : 5;
+  const uint32_t handles_per_writer = 512;
+  const uint32_t num_handles = handles_per_writer * num_writers;
+
+  std::unique_ptr<Registry> registry(new Registry());
+  registry->setReaders(num_readers);
+  std::unique_ptr<HandleState[]> handles(new HandleState[num_handles + 1]);
+  Errors errors;
+  std::atomic<bool> running{true};
+  std::atomic<uint64_t> lookups{0};
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> updates{0};
+
+  std::vector<std::thread> threads;
+  for (int reader = 0; reader < num_readers; reader++) {
+    threads.emplace_back([&, reader] {
+      std::mt19937 random(reader + 1);
+      uint64_t local_lookups = 0;
+      uint64_t local_hits = 0;
+      while (running) {
+        for (int i = 0; i < kLookupsPerQuiescent; i++) {
+          uint32_t handle = random() % num_handles + 1;
+          HandleState &state = handles[handle];
+          uint64_t before = state.generation.load();
+          FakeStream *stream = registry->find(handle);
+          uint64_t after = state.generation.load();
+          local_lookups++;
+          if (stream == nullptr) {
+            if (before % 4 == 2 && before == after) {
+              errors.missed++;
+            }
+            continue;
+          }
+          local_hits++;
+          if (stream->magic.load() != kAlive) {
+            errors.destroyed++;
+            continue;
+          }
+          if (stream->handle != handle) {
+            errors.wrong_handle++;
+          } else if (before >= stream->generation + 2) {
+            errors.stale++;
+          }
+        }
+        registry->onQuiescent(reader);
+        // Like BridgeIO's first receive thread
+        if (reader == 0) {
+          registry->reclaim();
+        }
+      }
+      registry->offline(reader);
+      lookups += local_lookups;
+      hits += local_hits;
+    });
+  }
+
+  for (int writer = 0; writer < num_writers; writer++) {
+    threads.emplace_back([&, writer] {
+      std::mt19937 random(1000 + writer);
+      uint32_t first = writer * handles_per_writer + 1;
+      uint64_t local_updates = 0;
+      while (running) {
+        uint32_t handle = first + random() % handles_per_writer;
+        HandleState &state = handles[handle];
+        uint64_t generation = state.generation.load();
+        state.generation.store(generation + 1);
+        if (state.stream == nullptr) {
+          auto stream = std::make_shared<FakeStream>(handle, generation + 2);
+          if (!registry->add(handle, stream)) {
+            errors.writer++;
+          }
+          state.stream = stream;
+        } else {
+          // Another stream must neither take nor release a handle it does not own
+          auto intruder = std::make_shared<FakeStream>(handle, generation);
+          if (registry->add(handle, intruder) || registry->remove(handle, intruder)) {
+            errors.writer++;
+          }
+          if (!registry->remove(handle, state.stream)) {
+            errors.writer++;
+          }
+          state.stream.reset();
+        }
+        state.generation.store(generation + 2);
+        local_updates++;
+      }
+      updates += local_updates;
+    });
+  }
+
+  std::this_thread::sleep_for(std::chrono::seconds(seconds));
+  running = false;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Drop everything still registered: with every reader offline all tables can go
+  for (uint32_t handle = 1; handle <= num_handles; handle++) {
+    if (handles[handle].stream != nullptr && !registry->remove(handle, handles[handle].stream)) {
+      errors.writer++;
+    }
+    handles[handle].stream.reset();
+  }
+  registry->reclaim();
+  size_t retired = registry->retiredCount();
+  int64_t leaked = live_streams.load();
+  registry.reset();
+
+  printf("readers: %d, writers: %d, seconds: %d\n", num_readers, num_writers, seconds);
+  printf("lookups: %lu (%.1f M/s), hits: %lu, updates: %lu\n",
+         static_cast<unsigned long>(lookups.load()),  // NOLINT
+         lookups.load() / 1e6 / seconds,
+         static_cast<unsigned long>(hits.load()),  // NOLINT
+         static_cast<unsigned long>(updates.load()));  // NOLINT
+  printf("wrong handle: %lu, destroyed: %lu, stale: %lu, missed: %lu, writer: %lu\n",
+         static_cast<unsigned long>(errors.wrong_handle.load()),  // NOLINT
+         static_cast<unsigned long>(errors.destroyed.load()),  // NOLINT
+         static_cast<unsigned long>(errors.stale.load()),  // NOLINT
+         static_cast<unsigned long>(errors.missed.load()),  // NOLINT
+         static_cast<unsigned long>(errors.writer.load()));  // NOLINT
+  printf("retired tables left: %zu, streams leaked: %ld\n", retired, static_cast<long>(leaked));  // NOLINT
+
+  bool failed = errors.wrong_handle || errors.destroyed || errors.stale || errors.missed || errors.writer ||
+                retired != 0 || leaked != 0 || live_streams.load() != 0;
+  printf("%s\n", failed ? "FAILED" : "OK");
+  return failed ? 1 : 0;
+}
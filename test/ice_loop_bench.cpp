@@ -0,0 +1,212 @@
+/*
+ * ice_loop_bench: connects pairs of LibNiceConnections over loopback and reports the thread
+ * count, RSS and one-way packet latency, with one GMainLoop thread per connection or with the
+ * shared GlibContextPool.
+ *
+ *   ice_loop_bench [pairs] [loops] [packets_per_pair]
+ *
+ * loops 0 runs every connection on its own loop thread, the model before GlibContextPool.
+ */
+
+#include <unistd.h>
+
+#include <chrono>  // NOLINT
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "LibNiceConnection.h"
+#include "SdpInfo.h"
+#include "lib/LatencyHistogram.h"
+#include "thread/GlibContextPool.h"
+
+using erizo::CandidateInfo;
+using erizo::GlibContextPool;
+using erizo::IceConfig;
+using erizo::IceConnection;
+using erizo::IceConnectionListener;
+using erizo::IceState;
+using erizo::LatencyHistogram;
+using erizo::LibNiceConnection;
+using erizo::packetPtr;
+
+namespace {
+
+// Counts connections reaching each state, so the main thread can wait for all of them
+class Progress {
+ public:
+  void add(int *counter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    (*counter)++;
+    cond_.notify_all();
+  }
+
+  bool waitFor(int *counter, int target, std::chrono::seconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cond_.wait_for(lock, timeout, [counter, target] { return *counter >= target; });
+  }
+
+  int gathered = 0;
+  int ready = 0;
+  int failed = 0;
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cond_;
+};
+
+class Peer : public IceConnectionListener {
+ public:
+  Peer(const std::string &id, Progress *progress, LatencyHistogram *latency)
+      : progress_{progress}, latency_{latency} {
+    IceConfig config;
+    config.media_type = erizo::VIDEO_TYPE;
+    config.transport_name = "video";
+    config.connection_id = id;
+    config.ice_components = 1;
+    config.network_interface = "lo";
+    connection.reset(LibNiceConnection::create(config));
+  }
+
+  void onPacketReceived(packetPtr packet) override {
+    int64_t sent;
+    if (packet->length >= static_cast<int>(sizeof(sent))) {
+      memcpy(&sent, packet->data, sizeof(sent));
+      latency_->record(LatencyHistogram::now() - sent);
+    }
+  }
+
+  void onCandidate(const CandidateInfo &candidate, IceConnection *conn) override {
+    std::lock_guard<std::mutex> lock(candidates_mutex_);
+    candidates_.push_back(candidate);
+  }
+
+  void updateIceState(IceState state, IceConnection *conn) override {
+    if (state == IceState::CANDIDATES_RECEIVED) {
+      progress_->add(&progress_->gathered);
+    } else if (state == IceState::READY) {
+      progress_->add(&progress_->ready);
+    } else if (state == IceState::FAILED) {
+      progress_->add(&progress_->failed);
+    }
+  }
+
+  // Hands our credentials and candidates to the remote side, like signaling would
+  void connectTo(Peer *remote) {
+    std::vector<CandidateInfo> candidates;
+    {
+      std::lock_guard<std::mutex> lock(candidates_mutex_);
+      candidates = candidates_;
+    }
+    remote->connection->setRemoteCredentials(connection->getLocalUsername(),
+                                             connection->getLocalPassword());
+    remote->connection->setRemoteCandidates(candidates, true);
+    remote->connection->setReceivedLastCandidate(true);
+  }
+
+  std::unique_ptr<LibNiceConnection> connection;
+
+ private:
+  Progress *progress_;
+  LatencyHistogram *latency_;
+  std::mutex candidates_mutex_;
+  std::vector<CandidateInfo> candidates_;
+};
+
+int threadCount() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 8, "Threads:") == 0) {
+      return atoi(line.c_str() + 8);
+    }
+  }
+  return -1;
+}
+
+long rssKb() {  // NOLINT
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmRSS:") == 0) {
+      return atol(line.c_str() + 6);
+    }
+  }
+  return -1;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int pairs = argc > 1 ? atoi(argv[1]) : 1000;
+  int loops = argc > 2 ? atoi(argv[2]) : 4;
+  int packets = argc > 3 ? atoi(argv[3]) : 100;
+  const std::chrono::seconds timeout(120);
+
+  if (loops > 0) {
+    GlibContextPool::getInstance()->start(loops);
+  }
+  printf("pairs: %d, loops: %d (%s), packets per pair: %d\n", pairs, loops,
+         loops > 0 ? "shared" : "thread per connection", packets);
+  printf("baseline      threads: %d, rss: %ld kB\n", threadCount(), rssKb());
+
+  Progress progress;
+  LatencyHistogram latency;
+  std::vector<std::shared_ptr<Peer>> peers;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < pairs * 2; i++) {
+    auto peer = std::make_shared<Peer>("bench_" + std::to_string(i), &progress, &latency);
+    peer->connection->setIceListener(peer);
+    peer->connection->start();
+    peers.push_back(peer);
+  }
+  if (!progress.waitFor(&progress.gathered, pairs * 2, timeout)) {
+    printf("gathering timed out, gathered: %d\n", progress.gathered);
+  }
+  for (int i = 0; i < pairs; i++) {
+    peers[2 * i]->connectTo(peers[2 * i + 1].get());
+    peers[2 * i + 1]->connectTo(peers[2 * i].get());
+  }
+  // Both ends of a pair go READY
+  if (!progress.waitFor(&progress.ready, pairs * 2, timeout)) {
+    printf("connecting timed out, ready: %d, failed: %d\n", progress.ready, progress.failed);
+  }
+  double setup_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  printf("connected     threads: %d, rss: %ld kB, ready: %d/%d in %.0f ms\n",
+         threadCount(), rssKb(), progress.ready, pairs * 2, setup_ms);
+
+  // Spread the sends so the latency measures dispatch, not a burst queued on the sockets
+  char buffer[200] = {0};
+  for (int round = 0; round < packets; round++) {
+    for (int i = 0; i < pairs; i++) {
+      int64_t now = LatencyHistogram::now();
+      memcpy(buffer, &now, sizeof(now));
+      peers[2 * i]->connection->sendData(1, buffer, sizeof(buffer));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  printf("latency       received: %lu/%lu, p50: %.1f us, p99: %.1f us, p99.9: %.1f us, max: %.1f us\n",
+         static_cast<unsigned long>(latency.count()),  // NOLINT
+         static_cast<unsigned long>(pairs) * packets,  // NOLINT
+         latency.percentile(50) / 1000.0, latency.percentile(99) / 1000.0,
+         latency.percentile(99.9) / 1000.0, latency.max() / 1000.0);
+
+  start = std::chrono::steady_clock::now();
+  for (auto &peer : peers) {
+    peer->connection->close();
+  }
+  peers.clear();
+  GlibContextPool::getInstance()->close();
+  printf("closed in %.0f ms, threads: %d, rss: %ld kB\n",
+         std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+         threadCount(), rssKb());
+  return 0;
+}
@@ -0,0 +1,160 @@
+/*
+ * mixer_startup_bench: times StreamMixer init and close for mixers of many layers, and reports
+ * the thread count and RSS each of them adds, with the receive Call shared by all layers and
+ * the webrtc threads borrowed from MixerThreadPool.
+ *
+ *   mixer_startup_bench [mixers] [layers] [rounds] [mixer_threads]
+ *
+ * Every round starts `mixers` mixers of `layers` layers at once, then closes them. Layers are
+ * laid out on a grid of a 1280x720 canvas. No media is sent, so this measures the setup and
+ * teardown of the webrtc objects only. Each mixer writes its webrtc log to
+ * <stream_id>.webrtc.log in the working directory.
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "media/mixers/MixerThreadPool.h"
+#include "media/mixers/StreamMixer.h"
+#include "media/mixers/mixer.h"
+#include "thread/CompositorPool.h"
+
+using erizo::CompositorPool;
+using erizo::MixerThreadPool;
+using erizo::StreamMixer;
+
+namespace {
+
+int threadCount() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 8, "Threads:") == 0) {
+      return atoi(line.c_str() + 8);
+    }
+  }
+  return -1;
+}
+
+long rssKb() {  // NOLINT
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmRSS:") == 0) {
+      return atol(line.c_str() + 6);
+    }
+  }
+  return -1;
+}
+
+double msSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+Mixer makeMixer(int mixer_index, int num_layers) {
+  Mixer mixer;
+  mixer.appid = 0;
+  mixer.id = "bench_mixer_" + std::to_string(mixer_index);
+  mixer.stream_id = mixer.id;
+  mixer.client_id = "cli_" + mixer.id;
+  mixer.bridge_ip = "127.0.0.1";
+  mixer.bridge_port = 0;
+  mixer.video_ssrc = 10000 + mixer_index * 1000;
+  mixer.audio_ssrc = mixer.video_ssrc + 1;
+  mixer.bitrate = 2000000;
+  mixer.width = 1280;
+  mixer.height = 720;
+  mixer.fps = 25;
+
+  int columns = static_cast<int>(std::ceil(std::sqrt(num_layers)));
+  int rows = (num_layers + columns - 1) / columns;
+  for (int i = 0; i < num_layers; i++) {
+    Layer layer;
+    layer.stream_id = mixer.id + "_stream_" + std::to_string(i);
+    layer.index = i;
+    layer.width = mixer.width / columns;
+    layer.height = mixer.height / rows;
+    layer.off_x = (i % columns) * layer.width;
+    layer.off_y = (i / columns) * layer.height;
+    layer.video_ssrc = mixer.video_ssrc + 2 + i * 2;
+    layer.audio_ssrc = layer.video_ssrc + 1;
+    layer.bridge_stream.id = "bridge_" + layer.stream_id;
+    layer.bridge_stream.src_stream_id = layer.stream_id;
+    layer.bridge_stream.sender_ip = "127.0.0.1";
+    layer.bridge_stream.sender_port = 0;
+    mixer.layers.push_back(layer);
+  }
+  return mixer;
+}
+
+struct Sample {
+  double total = 0;
+  double max = 0;
+  void add(double value) {
+    total += value;
+    max = std::max(max, value);
+  }
+};
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int num_mixers = argc > 1 ? atoi(argv[1]) : 1;
+  int num_layers = argc > 2 ? atoi(argv[2]) : 16;
+  int rounds = argc > 3 ? atoi(argv[3]) : 10;
+  int mixer_threads = argc > 4 ? atoi(argv[4]) : 4;
+
+  MixerThreadPool::getInstance()->start(mixer_threads);
+  CompositorPool::getInstance()->start(2);
+  int base_threads = threadCount();
+  long base_rss = rssKb();  // NOLINT
+  printf("mixers: %d, layers: %d, rounds: %d, mixer threads: %d\n", num_mixers, num_layers, rounds, mixer_threads);
+  printf("baseline threads: %d, rss: %ld kB\n", base_threads, base_rss);
+
+  Sample init_ms;
+  Sample close_ms;
+  int max_threads = 0;
+  long max_rss = 0;  // NOLINT
+  int failures = 0;
+  for (int round = 0; round < rounds; round++) {
+    std::vector<std::shared_ptr<StreamMixer>> mixers;
+    for (int i = 0; i < num_mixers; i++) {
+      Mixer config = makeMixer(i, num_layers);
+      auto mixer = std::make_shared<StreamMixer>();
+      auto start = std::chrono::steady_clock::now();
+      if (mixer->init(config) != 0) {
+        failures++;
+      }
+      init_ms.add(msSince(start));
+      mixers.push_back(mixer);
+    }
+    max_threads = std::max(max_threads, threadCount());
+    max_rss = std::max(max_rss, rssKb());
+
+    for (auto &mixer : mixers) {
+      auto start = std::chrono::steady_clock::now();
+      mixer->close();
+      close_ms.add(msSince(start));
+    }
+    mixers.clear();
+  }
+
+  int count = std::max(1, rounds * num_mixers);
+  printf("init:  mean %.1f ms, max %.1f ms\n", init_ms.total / count, init_ms.max);
+  printf("close: mean %.1f ms, max %.1f ms\n", close_ms.total / count, close_ms.max);
+  printf("running: threads %d (+%.1f per mixer), rss %ld kB (+%.0f kB per mixer)\n",
+         max_threads, static_cast<double>(max_threads - base_threads) / std::max(1, num_mixers),
+         max_rss, static_cast<double>(max_rss - base_rss) / std::max(1, num_mixers));
+  printf("after close: threads %d, rss %ld kB, failed inits: %d\n", threadCount(), rssKb(), failures);
+
+  CompositorPool::getInstance()->close();
+  MixerThreadPool::getInstance()->close();
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+/*
+ * packet_pool_bench: counts the heap allocations and the time per forwarded packet with
+ * std::make_shared<DataPacket>, as the media paths used to allocate packets, and with the pooled
+ * makeDataPacket.
+ *
+ *   packet_pool_bench [packets] [subscribers] [in_flight]
+ *
+ * Every packet follows the forwarding path: it is received into a new packet, copied by
+ * MediaStream::onTransportData, then fanned out to every subscriber, whose outbound handlers
+ * each take a private copy of the shared packet like ensureWritable() does. The last in_flight
+ * copies are kept alive, as if still queued. Allocations are counted by replacing the global
+ * operator new, which both std::make_shared and the pool's slabs go through.
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "MediaDefinitions.h"
+
+using erizo::DataPacket;
+
+namespace {
+
+uint64_t allocations = 0;
+
+struct MakeShared {
+  static const char *name() { return "std::make_shared"; }
+  template <typename... Args>
+  static std::shared_ptr<DataPacket> make(Args&&... args) {
+    return std::make_shared<DataPacket>(std::forward<Args>(args)...);
+  }
+};
+
+struct MakeDataPacket {
+  static const char *name() { return "makeDataPacket"; }
+  template <typename... Args>
+  static std::shared_ptr<DataPacket> make(Args&&... args) {
+    return erizo::makeDataPacket(std::forward<Args>(args)...);
+  }
+};
+
+template <typename Factory>
+void run(int packets, int subscribers, int in_flight) {
+  char payload[1200] = {0};
+  std::vector<std::shared_ptr<DataPacket>> queued(in_flight * subscribers);
+  size_t next = 0;
+  // Warm up, so that only the steady state is measured
+  for (int pass = 0; pass < 2; pass++) {
+    uint64_t start_allocations = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < packets; i++) {
+      std::shared_ptr<DataPacket> received = Factory::make(0, payload, sizeof(payload), erizo::VIDEO_PACKET);
+      std::shared_ptr<DataPacket> packet = Factory::make(*received);
+      received.reset();
+      for (int subscriber = 0; subscriber < subscribers; subscriber++) {
+        std::shared_ptr<DataPacket> shared = packet;
+        if (shared.use_count() > 1) {
+          shared = Factory::make(*shared);
+        }
+        queued[next] = std::move(shared);
+        next = (next + 1) % queued.size();
+      }
+    }
+    double elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (pass == 1) {
+      printf("%-18s allocations per packet: %6.3f, ns per packet: %7.1f\n", Factory::name(),
+             static_cast<double>(allocations - start_allocations) / packets, elapsed_ns / packets);
+    }
+  }
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+  allocations++;
+  void *block = malloc(size);
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+  return block;
+}
+
+void operator delete(void *block) noexcept {
+  free(block);
+}
+
+void operator delete(void *block, size_t) noexcept {
+  free(block);
+}
+
+int main(int argc, char *argv[]) {
+  int packets = argc > 1 ? atoi(argv[1]) : 1000000;
+  int subscribers = argc > 2 ? atoi(argv[2]) : 4;
+  int in_flight = argc > 3 ? atoi(argv[3]) : 64;
+  packets = std::max(1, packets);
+  subscribers = std::max(1, subscribers);
+  in_flight = std::max(1, in_flight);
+
+  printf("packets: %d, subscribers: %d, in flight per subscriber: %d\n", packets, subscribers, in_flight);
+  run<MakeShared>(packets, subscribers, in_flight);
+  run<MakeDataPacket>(packets, subscribers, in_flight);
+  printf("pool slabs: %lu\n", static_cast<unsigned long>(erizo::PacketPool::getSlabCount()));  // NOLINT
+  return 0;
+}
@@ -0,0 +1,170 @@
+/*
+ * thread_pool_skew_bench: runs streams of Zipf distributed bitrates on a ThreadPool and reports,
+ * every second, the utilization of each worker, the gap between the busiest and the idlest one
+ * and the p99 delay from posting a packet to running it, so that placement and rebalancing can
+ * be watched spreading a few hot streams.
+ *
+ *   thread_pool_skew_bench [workers] [streams] [seconds] [zipf_exponent] [load]
+ *
+ * Every 10 ms each stream gets one task that spins for its share of load * workers, the stream
+ * of rank r weighing 1 / r^zipf_exponent, which models the per-packet work of a stream of that
+ * bitrate. Ranks are shuffled, so where the hot streams land depends on placement alone. Half
+ * way through, streams / 2 average streams join in a burst and the bench prints which workers
+ * they were placed on.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "lib/LatencyHistogram.h"
+#include "thread/ThreadPool.h"
+
+using erizo::LatencyHistogram;
+using erizo::ThreadPool;
+using erizo::Worker;
+using erizo::WorkerLoad;
+
+namespace {
+
+constexpr std::chrono::milliseconds kTick{10};
+// No single stream may need more than this share of a worker
+constexpr double kMaxStreamLoad = 0.9;
+
+struct Stream {
+  std::shared_ptr<Worker> lane;
+  std::chrono::nanoseconds cost;
+};
+
+void spin(std::chrono::nanoseconds cost) {
+  auto until = std::chrono::steady_clock::now() + cost;
+  while (std::chrono::steady_clock::now() < until) {
+  }
+}
+
+std::string describe(const std::vector<WorkerLoad> &loads) {
+  std::string text;
+  char buffer[64];
+  for (const WorkerLoad &load : loads) {
+    snprintf(buffer, sizeof(buffer), "%s%4.2f", text.empty() ? "" : " ", load.utilization);
+    text += buffer;
+  }
+  return text;
+}
+
+double gap(const std::vector<WorkerLoad> &loads) {
+  auto by_utilization = [](const WorkerLoad &a, const WorkerLoad &b) { return a.utilization < b.utilization; };
+  return std::max_element(loads.begin(), loads.end(), by_utilization)->utilization -
+      std::min_element(loads.begin(), loads.end(), by_utilization)->utilization;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int num_workers = argc > 1 ? atoi(argv[1]) : 4;
+  int num_streams = argc > 2 ? atoi(argv[2]) : 200;
+  int seconds = argc > 3 ? atoi(argv[3]) : 20;
+  double exponent = argc > 4 ? atof(argv[4]) : 1.2;
+  double load = argc > 5 ? atof(argv[5]) : 0.5;
+  num_workers = std::max(1, num_workers);
+  num_streams = std::max(1, num_streams);
+  seconds = std::max(2, seconds);
+
+  // Per tick cost of each rank, as a share of one worker
+  std::vector<double> shares(num_streams);
+  double total_weight = 0;
+  for (int rank = 0; rank < num_streams; rank++) {
+    shares[rank] = 1. / std::pow(rank + 1, exponent);
+    total_weight += shares[rank];
+  }
+  for (double &share : shares) {
+    share = std::min(kMaxStreamLoad, share / total_weight * load * num_workers);
+  }
+  std::mt19937 random(1);
+  std::shuffle(shares.begin(), shares.end(), random);
+  auto costOf = [](double share) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(kTick * share);
+  };
+
+  std::vector<std::unique_ptr<LatencyHistogram>> delays;
+  for (int second = 0; second < seconds; second++) {
+    delays.emplace_back(new LatencyHistogram());
+  }
+
+  ThreadPool pool(num_workers);
+  pool.start();
+  printf("workers: %d, streams: %d, seconds: %d, zipf exponent: %.2f, load: %.2f, hottest stream: %.2f\n",
+         num_workers, num_streams, seconds, exponent, load,
+         *std::max_element(shares.begin(), shares.end()));
+
+  // Placed in one burst, before any load has been measured
+  std::vector<Stream> streams;
+  for (double share : shares) {
+    streams.push_back(Stream{pool.getLessUsedWorker(), costOf(share)});
+  }
+
+  std::atomic<bool> running{true};
+  auto start = std::chrono::steady_clock::now();
+  std::thread driver([&] {
+    bool joined = false;
+    auto next = start;
+    while (running) {
+      auto now = std::chrono::steady_clock::now();
+      int second = std::min<int>(seconds - 1, std::chrono::duration_cast<std::chrono::seconds>(now - start).count());
+      if (!joined && second >= seconds / 2) {
+        joined = true;
+        std::vector<WorkerLoad> before = pool.getWorkerLoads();
+        double mean_share = load * num_workers / num_streams;
+        for (int i = 0; i < num_streams / 2; i++) {
+          streams.push_back(Stream{pool.getLessUsedWorker(), costOf(mean_share)});
+        }
+        std::vector<WorkerLoad> after = pool.getWorkerLoads();
+        std::string placed;
+        for (size_t index = 0; index < after.size(); index++) {
+          placed += (placed.empty() ? "" : " ") + std::to_string(after[index].lanes - before[index].lanes);
+        }
+        printf("burst of %d streams placed per worker: %s\n", num_streams / 2, placed.c_str());
+      }
+      LatencyHistogram *delay = delays[second].get();
+      for (const Stream &stream : streams) {
+        int64_t posted = LatencyHistogram::now();
+        std::chrono::nanoseconds cost = stream.cost;
+        stream.lane->task([delay, posted, cost] {
+          delay->record(LatencyHistogram::now() - posted);
+          spin(cost);
+        });
+      }
+      next += kTick;
+      std::this_thread::sleep_until(next);
+    }
+  });
+
+  printf("second  gap   p99 delay  utilization per worker\n");
+  double first_gap = 0;
+  double last_gap = 0;
+  for (int second = 0; second < seconds; second++) {
+    std::this_thread::sleep_until(start + std::chrono::seconds(second + 1));
+    // The pool refreshes its loads once per second, just before this
+    std::vector<WorkerLoad> loads = pool.getWorkerLoads();
+    last_gap = gap(loads);
+    if (second == 1) {
+      first_gap = last_gap;
+    }
+    printf("%6d  %4.2f  %6.2f ms  %s\n", second, last_gap,
+           delays[second]->percentile(99) / 1e6, describe(loads).c_str());
+  }
+  running = false;
+  driver.join();
+  pool.close();
+
+  printf("utilization gap: %.2f after the initial placement, %.2f at the end\n", first_gap, last_gap);
+  return 0;
+}